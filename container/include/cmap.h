@@ -0,0 +1,58 @@
+/* cmap.h
+ * Mac Radigan
+ */
+
+  #pragma once
+
+  #include "map.h"
+  #include <pthread.h>
+  #include <sys/types.h>
+
+  /*
+   * cmap_t - a concurrent hash map sharded over independent map_t tables
+   *
+   *   a key's shard is chosen from the high bits of its (remixed) hash code,
+   *   leaving the low bits to select buckets within the shard; the hash code
+   *   is computed once per operation and passed down to the shard's map.
+   *   each shard sits on its own cache lines behind a reader-writer lock, so
+   *   readers of a shard proceed in parallel and writers only serialize
+   *   within a shard.
+   *
+   *   cmap_get copies the value out under the shard lock, since a pointer
+   *   into a shard's table would not survive a concurrent insert.
+   */
+
+  typedef struct cmap_shard_s
+  {
+    _Alignas(64) pthread_rwlock_t lock;
+    map_t map;
+  } cmap_shard_t;
+
+  typedef struct cmap_s
+  {
+    cmap_shard_t *shards;
+    size_t        shard_count; /* a power of two */
+    unsigned int  shard_bits;  /* log2 of shard_count */
+  } cmap_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  status_t cmap_make(cmap_t *map, const size_t size, const size_t shards);
+
+  status_t cmap_free(cmap_t *map);
+
+  status_t cmap_insert(cmap_t *map, object_t *key, object_t *value);
+
+  status_t cmap_remove(cmap_t *map, object_t *key);
+
+  status_t cmap_get(cmap_t *map, object_t *key, object_t *value);
+
+  size_t cmap_count(cmap_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* EOF */
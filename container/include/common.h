@@ -27,11 +27,43 @@
     struct cell_s *cdr;
   } cell_t;
 
+  /*
+   * pool_t - a slab allocator handing out fixed-size cells
+   *
+   *   cells are carved from slabs of slab_cells cells each; released cells
+   *   are kept on a free list threaded through the cells themselves, and
+   *   pool_reset returns every cell at once without visiting them.
+   */
+  typedef struct slab_s
+  {
+    struct slab_s *next;
+    double         align; /* pads the header so cells are suitably aligned */
+  } slab_t;
+
+  typedef struct pool_s
+  {
+    size_t  cell_size;    /* bytes per cell */
+    size_t  slab_cells;   /* cells per slab */
+    slab_t *slabs;        /* most recently allocated slab first */
+    void   *free_list;    /* released cells */
+    char   *cursor;       /* next unused cell in the newest slab */
+    char   *limit;        /* end of the newest slab */
+    size_t  live;         /* cells currently handed out */
+    size_t  slab_count;   /* slabs currently held */
+  } pool_t;
+
   typedef element_t object_t;
+  typedef unsigned long hashcode_t;
   typedef int (*compare_fn_t)(const object_t *object1, const object_t *object2);
   typedef status_t (*print_fn_t)(const object_t *object, FILE *stream);
-  typedef object_t* (*copy_fn_t)(const object_t *object);
+  /* elements live inline in container cells:  copy constructs source into
+   *   the storage at target, and free destroys the element in place, leaving
+   *   its storage to the container */
+  typedef void (*copy_fn_t)(object_t *target, const object_t *source);
   typedef void (*free_fn_t)(object_t *object);
+  typedef hashcode_t (*hash_fn_t)(const object_t *object);
+  typedef void* (*alloc_fn_t)(pool_t *pool, size_t size);
+  typedef void (*release_fn_t)(pool_t *pool, void *block);
 
   typedef struct methods_s
   {
@@ -39,6 +71,10 @@
     print_fn_t   print;
     copy_fn_t    copy;
     free_fn_t    free;
+    hash_fn_t    hash;
+    alloc_fn_t   alloc;   /* container cell allocator */
+    release_fn_t release; /* container cell deallocator */
+    pool_t      *pool;    /* allocator state, NULL for the system heap */
   } methods_t;
 
 #ifdef __cplusplus
@@ -48,8 +84,17 @@ extern "C" {
   void check(status_t status, const char *messsage);
   status_t object_print(const object_t *object, FILE *stream);
   int object_compare(const object_t *object1, const object_t *object2);
-  object_t *object_copy(const object_t *object);
+  void object_copy(object_t *target, const object_t *source);
   void object_free(object_t *object);
+  hashcode_t object_hash(const object_t *object);
+  void *object_alloc(pool_t *pool, size_t size);
+  void object_release(pool_t *pool, void *block);
+
+  status_t pool_make(pool_t *pool, size_t cell_size, size_t slab_cells);
+  status_t pool_free(pool_t *pool);
+  status_t pool_reset(pool_t *pool);
+  void *pool_alloc(pool_t *pool);
+  void pool_release(pool_t *pool, void *cell);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,60 @@
+/* cstack.h
+ * Mac Radigan
+ */
+
+  #pragma once
+
+  #include "common.h"
+  #include <stdatomic.h>
+  #include <stdint.h>
+  #include <sys/types.h>
+
+  /*
+   * cstack_t - a lock-free (Treiber) stack for multiple producers and consumers
+   *
+   *   nodes are preallocated in a single array and recycled through a
+   *   lock-free free list, so memory is never returned while the stack is in
+   *   use.  the head of the stack and of the free list are 64-bit words
+   *   packing a node index with a modification tag:  a compare-and-swap
+   *   fails if the head was popped and pushed back in between (ABA).
+   */
+
+  typedef struct cstack_node_s
+  {
+    cell_t           cell;   /* car holds the object, cdr mirrors next */
+    object_t         object;
+    _Atomic uint32_t next;   /* index of the next node plus one, zero at the end */
+  } cstack_node_t;
+
+  typedef struct cstack_s
+  {
+    _Alignas(64) _Atomic uint64_t head; /* tag << 32 | (index + 1) */
+    _Alignas(64) _Atomic uint64_t free; /* tag << 32 | (index + 1) */
+    _Alignas(64) methods_t methods;
+    cstack_node_t *nodes;
+    size_t         capacity;
+  } cstack_t;
+
+  /* upper bound on spins between failed compare-and-swaps */
+  #define CSTACK_BACKOFF_LIMIT 1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  status_t cstack_make(cstack_t *stack, const size_t capacity);
+
+  status_t cstack_free(cstack_t *stack);
+
+  status_t cstack_push(cstack_t *stack, const object_t *object);
+
+  status_t cstack_pop(cstack_t *stack, object_t *object);
+
+  /* NB:  not safe against concurrent pushes and pops */
+  status_t cstack_print(cstack_t *stack, FILE *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* EOF */
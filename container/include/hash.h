@@ -0,0 +1,42 @@
+/* hash.h
+ * Mac Radigan
+ */
+
+  #pragma once
+
+  #include "common.h"
+  #include <stdint.h>
+  #include <sys/types.h>
+
+  /*
+   * hash functions for the methods_t hash slot
+   *
+   *   hash_djb2   - the original byte-at-a-time hash, kept for reference
+   *   hash_mix64  - an integer finalizer for element_t-sized keys; every
+   *                 input bit affects every output bit, so both the low
+   *                 bits (bucket) and high bits (shard) are well mixed
+   *   hash_bytes  - a 64-bit hash of arbitrary length byte keys:  short
+   *                 keys are folded with 64x64->128 bit multiplies, long
+   *                 keys are consumed in 64-byte stripes by eight
+   *                 independent lanes of 32x32->64 bit multiplies, which
+   *                 the compiler maps onto SIMD registers
+   */
+
+  /* bytes per stripe of the long-key path of hash_bytes */
+  #define HASH_STRIPE 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  hashcode_t hash_djb2(const void *buf, size_t size);
+
+  hashcode_t hash_mix64(uint64_t x);
+
+  hashcode_t hash_bytes(const void *buf, size_t size, uint64_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* EOF */
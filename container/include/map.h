@@ -5,21 +5,97 @@
   #pragma once
 
   #include "common.h"
+  #include <stdint.h>
   #include <sys/types.h>
 
+  /*
+   * open-addressing hash map with Robin Hood linear probing
+   *
+   *   keys and values are stored inline in a contiguous slot array, so a
+   *   probe touches one cache line rather than chasing a pointer per slot.
+   *   deletion uses backward shifting (no tombstones), and growth is
+   *   incremental:  when the load factor is exceeded a table of twice the
+   *   size is allocated, and subsequent inserts and removals migrate a few
+   *   slots of the old table at a time until it is drained.
+   *
+   *   pointers returned by map_get are invalidated by map_insert and
+   *   map_remove.
+   *
+   *   map_insert constructs the stored key and value with methods.copy,
+   *   and map_remove and map_free destroy them with methods.free; within
+   *   the table they are moved bitwise (on displacement and rehashing), so
+   *   they must not point into themselves.  snapshots (map_save) hold the
+   *   slots as they are, and so only plain keys and values survive them.
+   */
+
+  typedef struct map_slot_s
+  {
+    unsigned int distance; /* probe distance plus one, zero if empty */
+    object_t     key;
+    object_t     value;
+  } map_slot_t;
+
+  typedef struct map_table_s
+  {
+    map_slot_t  *slots;
+    size_t       size;     /* number of slots, a power of two */
+    size_t       count;    /* number of occupied slots */
+  } map_table_t;
+
   typedef struct map_s
   {
     methods_t    methods;
-    object_t   **table;
-    size_t       size;
+    map_table_t  table;    /* active table */
+    map_table_t  old;      /* table being drained by an incremental rehash */
+    size_t       cursor;   /* next slot of the old table to migrate */
+    void        *mapping;  /* read-only file mapping, NULL if heap allocated */
+    size_t       mapped;   /* bytes mapped */
   } map_t;
 
+  /*
+   * on-disk snapshot of a map_t
+   *
+   *   a header padded to MAP_FILE_ALIGN bytes followed by the slot array
+   *   exactly as it is laid out in memory.  slots hold no pointers, so the
+   *   file is position independent and map_open_mmap queries it in place:
+   *   only the pages of the buckets touched are ever read.  the header
+   *   checksum is verified on open; the slot checksum, which requires
+   *   reading the whole file, is verified on demand by map_verify.
+   *
+   *   NB:  the layout is native-endian, and the file must be opened with
+   *        the hash method it was saved with (checked by hashing a probe
+   *        key).
+   */
+  #define MAP_FILE_MAGIC   "MOCKMAP"
+  #define MAP_FILE_VERSION 1
+  #define MAP_FILE_ALIGN   4096
+
+  typedef struct map_header_s
+  {
+    char     magic[8];
+    uint32_t version;
+    uint32_t slot_size;        /* sizeof(map_slot_t) */
+    uint64_t size;             /* number of slots, a power of two */
+    uint64_t count;            /* number of occupied slots */
+    uint64_t hash_probe;       /* hash of MAP_FILE_PROBE under the saved method */
+    uint64_t slot_checksum;    /* hash_bytes of the slot array */
+    uint64_t header_checksum;  /* hash_bytes of the fields above */
+  } map_header_t;
+
+  /* maximum load factor, as a fraction of MAP_LOAD_DENOMINATOR */
+  #define MAP_LOAD_NUMERATOR   7
+  #define MAP_LOAD_DENOMINATOR 8
+
+  /* slots of the old table visited per mutating operation during a rehash */
+  #define MAP_REHASH_STEP      16
+
+  /* keys hashed and prefetched ahead of resolution by the batch operations */
+  #define MAP_BATCH            16
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-  typedef unsigned long hashcode_t;
-
   status_t map_make(map_t *map, const size_t size);
 
   status_t map_free(map_t *map);
@@ -30,6 +106,45 @@ extern "C" {
 
   object_t *map_get(map_t *map, object_t *key);
 
+  /*
+   * operations on a key whose hash code the caller already holds
+   *
+   *   hashcode must be map_hash(map, key); callers that hash a key for their
+   *   own purposes (e.g. cmap_t choosing a shard) pass it down rather than
+   *   have the map hash the key again.
+   */
+  status_t map_insert_hashed(map_t *map, object_t *key, object_t *value,
+                             hashcode_t hashcode);
+
+  status_t map_remove_hashed(map_t *map, object_t *key, hashcode_t hashcode);
+
+  object_t *map_get_hashed(map_t *map, object_t *key, hashcode_t hashcode);
+
+  /*
+   * batch operations over arrays of keys (and values)
+   *
+   *   keys are hashed and their home slots prefetched MAP_BATCH at a time
+   *   before any is resolved, overlapping the cache misses of a batch.
+   *   map_insert_batch sizes the table for the whole batch up front and
+   *   fails if any key was already present (the remaining keys are still
+   *   inserted); map_get_batch stores a pointer to each value, or NULL, and
+   *   returns the number of keys found.
+   */
+  status_t map_insert_batch(map_t *map, object_t *keys, object_t *values, size_t count);
+
+  size_t map_get_batch(map_t *map, object_t *keys, object_t **values, size_t count);
+
+  size_t map_count(const map_t *map);
+
+  hashcode_t map_hash(const map_t *map, const object_t *key);
+
+  status_t map_save(map_t *map, const char *path);
+
+  /* maps a saved map read-only; map_insert and map_remove will fail */
+  status_t map_open_mmap(map_t *map, const char *path);
+
+  status_t map_verify(const map_t *map);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,307 @@
+// map.hpp
+// Mac Radigan
+
+  #pragma once
+
+  #include "common.h"
+  #include <cstddef>
+  #include <cstdint>
+  #include <functional>
+  #include <memory>
+  #include <new>
+  #include <type_traits>
+  #include <utility>
+
+  namespace mock::container {
+
+    // ==========================================================================
+    // Hash
+    // ==========================================================================
+    //
+    //   default hash policy:  integral keys are finalized with SplitMix64 (the
+    //     same mixing as hash_mix64), other keys remix their std::hash so the
+    //     low bits are usable for power-of-two masking
+    //
+    template<class K>
+    struct Hash
+    {
+      inline std::size_t operator()(const K &key) const noexcept
+      {
+        std::uint64_t x;
+        if constexpr(std::is_integral_v<K> || std::is_enum_v<K>)
+          x = static_cast<std::uint64_t>(key);
+        else
+          x = std::hash<K>{}(key);
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return static_cast<std::size_t>(x);
+      } // operator()
+    }; // Hash
+
+    // ==========================================================================
+    // HashMap
+    // ==========================================================================
+    //
+    //   a statically dispatched counterpart of map_t:  the same Robin Hood
+    //     linear probing with backward-shift deletion, with hashing and key
+    //     comparison inlined through the Hash and Eq policies.  key/value
+    //     pairs are stored inline in the slots; non-trivial types are moved,
+    //     never copied, when slots are displaced or the table grows.
+    //
+    //   unlike map_t the table grows all at once rather than incrementally.
+    //   pointers returned by get are invalidated by insert and remove.  a
+    //     moved-from map is empty and has no table; it remains usable, and
+    //     allocates one on its next insert.
+    //
+    template<class K, class V, class H = Hash<K>, class E = std::equal_to<K>>
+    class HashMap
+    {
+     public:
+
+      using value_type = std::pair<K, V>;
+
+     private:
+
+      struct Slot
+      {
+        std::uint32_t distance; // probe distance plus one, zero if empty
+        alignas(value_type) unsigned char storage[sizeof(value_type)];
+        inline value_type& entry() { return *std::launder(reinterpret_cast<value_type*>(storage)); };
+      };
+
+     public:
+
+      // maximum load factor, as a fraction of load_denominator
+      static constexpr std::size_t load_numerator   = 7;
+      static constexpr std::size_t load_denominator = 8;
+
+      explicit HashMap(std::size_t size = 0, const H &hash = H(), const E &equal = E())
+       : hash_(hash), equal_(equal)
+       {
+         allocate(slots_for(size));
+       };
+
+      HashMap(const HashMap&) = delete;
+      HashMap& operator=(const HashMap&) = delete;
+
+      HashMap(HashMap &&o) noexcept
+       : slots_(std::exchange(o.slots_, nullptr)),
+         size_(std::exchange(o.size_, 0)),
+         count_(std::exchange(o.count_, 0)),
+         hash_(std::move(o.hash_)),
+         equal_(std::move(o.equal_))
+       {};
+
+      ~HashMap()
+      {
+        clear();
+        delete[] slots_;
+      } // ~HashMap
+
+      // inserts key -> value, returning false if the key is already present
+      template<class KK, class VV>
+      inline bool insert(KK &&key, VV &&value)
+      {
+        const std::size_t hashcode = hash_(key);
+        if(nullptr != find(key, hashcode)) return false;
+        if(count_ + 1 > capacity(size_)) rehash(size_ ? 2 * size_ : slots_for(1));
+        place(value_type(std::forward<KK>(key), std::forward<VV>(value)), hashcode);
+        return true;
+      } // insert
+
+      // returns the value stored for key, or nullptr
+      inline V* get(const K &key)
+      {
+        Slot *slot = find(key, hash_(key));
+        return (nullptr == slot) ? nullptr : &slot->entry().second;
+      } // get
+
+      inline const V* get(const K &key) const
+      {
+        return const_cast<HashMap*>(this)->get(key);
+      } // get
+
+      // removes key, returning false if it was not present
+      inline bool remove(const K &key)
+      {
+        Slot *slot = find(key, hash_(key));
+        if(nullptr == slot) return false;
+        erase(slot);
+        return true;
+      } // remove
+
+      inline std::size_t size() const { return count_; };
+
+      // grows the table to hold size entries without rehashing
+      inline void reserve(std::size_t size)
+      {
+        const std::size_t slots = slots_for(size);
+        if(slots > size_) rehash(slots);
+      } // reserve
+
+      inline void clear()
+      {
+        for(std::size_t k=0; k<size_; ++k)
+        {
+          if(slots_[k].distance)
+          {
+            slots_[k].entry().~value_type();
+            slots_[k].distance = 0;
+          }
+        }
+        count_ = 0;
+      } // clear
+
+      // visits each key/value pair in table order
+      template<class F>
+      inline void for_each(F &&f)
+      {
+        for(std::size_t k=0; k<size_; ++k)
+        {
+          if(slots_[k].distance) f(slots_[k].entry().first, slots_[k].entry().second);
+        }
+      } // for_each
+
+     private:
+
+      static inline std::size_t capacity(std::size_t slots)
+      {
+        return slots * load_numerator / load_denominator;
+      } // capacity
+
+      static inline std::size_t slots_for(std::size_t size)
+      {
+        std::size_t slots = 8;
+        while(capacity(slots) < size) slots <<= 1;
+        return slots;
+      } // slots_for
+
+      inline void allocate(std::size_t slots)
+      {
+        slots_ = new Slot[slots];
+        for(std::size_t k=0; k<slots; ++k) slots_[k].distance = 0;
+        size_  = slots;
+        count_ = 0;
+      } // allocate
+
+      inline Slot* find(const K &key, std::size_t hashcode)
+      {
+        if(0 == size_) return nullptr; // moved from
+        const std::size_t mask = size_ - 1;
+        std::size_t index = hashcode & mask;
+        for(std::uint32_t distance=1; ; ++distance)
+        {
+          Slot &slot = slots_[index];
+          // an empty slot, or one closer to its home than we are to ours,
+          //   terminates the probe sequence
+          if(slot.distance < distance) return nullptr;
+          if(equal_(slot.entry().first, key)) return &slot;
+          index = (index + 1) & mask;
+        }
+      } // find
+
+      // places an entry whose key is known to be absent
+      inline void place(value_type &&carry, std::size_t hashcode)
+      {
+        const std::size_t mask = size_ - 1;
+        std::size_t index = hashcode & mask;
+        std::uint32_t distance = 1;
+        for(;;)
+        {
+          Slot &slot = slots_[index];
+          if(0 == slot.distance)
+          {
+            ::new(slot.storage) value_type(std::move(carry));
+            slot.distance = distance;
+            ++count_;
+            return;
+          }
+          // Robin Hood:  take from the rich (near home), give to the poor
+          if(slot.distance < distance)
+          {
+            std::swap(slot.entry(), carry);
+            std::swap(slot.distance, distance);
+          }
+          index = (index + 1) & mask;
+          ++distance;
+        }
+      } // place
+
+      // removes an occupied slot by shifting its successors back
+      inline void erase(Slot *slot)
+      {
+        const std::size_t mask = size_ - 1;
+        std::size_t index = static_cast<std::size_t>(slot - slots_);
+        for(;;)
+        {
+          const std::size_t next = (index + 1) & mask;
+          Slot &successor = slots_[next];
+          if(successor.distance <= 1) break;
+          slots_[index].entry() = std::move(successor.entry());
+          slots_[index].distance = successor.distance - 1;
+          index = next;
+        }
+        slots_[index].entry().~value_type();
+        slots_[index].distance = 0;
+        --count_;
+      } // erase
+
+      inline void rehash(std::size_t slots)
+      {
+        Slot *old = slots_;
+        const std::size_t old_size = size_;
+        allocate(slots);
+        for(std::size_t k=0; k<old_size; ++k)
+        {
+          if(old[k].distance)
+          {
+            value_type &entry = old[k].entry();
+            const std::size_t hashcode = hash_(entry.first);
+            place(std::move(entry), hashcode);
+            entry.~value_type();
+          }
+        }
+        delete[] old;
+      } // rehash
+
+      Slot *slots_ = nullptr;
+      std::size_t size_  = 0;   // number of slots, a power of two
+      std::size_t count_ = 0;   // number of occupied slots
+      H hash_;
+      E equal_;
+
+    }; // HashMap
+
+    // thin wrappers preserving the C map API
+
+    template<class K, class V, class H, class E>
+    inline status_t map_insert(HashMap<K,V,H,E> &map, const K &key, const V &value)
+    {
+      return map.insert(key, value) ? SUCCESS : FAILURE;
+    } // map_insert
+
+    template<class K, class V, class H, class E>
+    inline status_t map_remove(HashMap<K,V,H,E> &map, const K &key)
+    {
+      return map.remove(key) ? SUCCESS : FAILURE;
+    } // map_remove
+
+    template<class K, class V, class H, class E>
+    inline V* map_get(HashMap<K,V,H,E> &map, const K &key)
+    {
+      return map.get(key);
+    } // map_get
+
+    template<class K, class V, class H, class E>
+    inline status_t map_free(HashMap<K,V,H,E> &map)
+    {
+      map.clear();
+      return SUCCESS;
+    } // map_free
+
+  } // mock::container
+
+// *EOF*
@@ -7,24 +7,60 @@
   #include "common.h"
   #include <sys/types.h>
 
-  typedef union stack_u
+  /* cells per slab of the stack's cell pool */
+  #define STACK_SLAB_CELLS 1024
+
+  /* objects per cell of an unrolled stack */
+  #define STACK_CHUNK_OBJECTS 64
+
+  /* cells per slab of an unrolled stack's cell pool */
+  #define STACK_SLAB_CHUNKS 16
+
+  /*
+   * an unrolled stack cell holding a run of objects inline
+   *
+   *   objects are filled from the back of the array towards the front, so
+   *   the front of the stack is objects[STACK_CHUNK_OBJECTS - count] and a
+   *   front-to-back traversal reads memory sequentially.
+   */
+  typedef struct stack_chunk_s
+  {
+    cell_t   cell;    /* car holds the objects, cdr the next chunk's cell */
+    size_t   count;   /* objects in use */
+    object_t objects[STACK_CHUNK_OBJECTS];
+  } stack_chunk_t;
+
+  typedef struct stack_s
   {
-    cell_t    head;
-    methods_t methods;
+    cell_t         head;
+    methods_t      methods;
+    pool_t         pool;      /* cells, each holding its object(s) inline */
+    boolean_t      unrolled;  /* cells are stack_chunk_t */
+    stack_chunk_t *spare;     /* emptied chunk kept to avoid churn at a boundary */
   } stack_t;
 
+  typedef status_t (*visit_fn_t)(const object_t *object, void *context);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
   status_t stack_make(stack_t *stack);
 
+  status_t stack_make_unrolled(stack_t *stack);
+
   status_t stack_free(stack_t *stack);
 
+  status_t stack_clear(stack_t *stack);
+
   status_t stack_insert_front(stack_t *stack, object_t *object);
 
   status_t stack_remove_front(stack_t *stack);
 
+  object_t *stack_front(stack_t *stack);
+
+  status_t stack_visit(stack_t *stack, visit_fn_t visit, void *context);
+
   status_t stack_print(stack_t *stack, FILE *stream);
 
 #ifdef __cplusplus
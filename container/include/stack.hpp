@@ -0,0 +1,196 @@
+// stack.hpp
+// Mac Radigan
+
+  #pragma once
+
+  #include "common.h"
+  #include <cstddef>
+  #include <iterator>
+  #include <memory>
+  #include <utility>
+  #include <vector>
+
+  namespace mock::container {
+
+    // ==========================================================================
+    // Stack
+    // ==========================================================================
+    //
+    //   a statically dispatched counterpart of stack_t:  elements of type T
+    //     are constructed in place inside their list node (no boxed copy),
+    //     nodes are carved from slabs of the allocator and recycled through a
+    //     free list, and copies and comparisons are resolved at compile time
+    //
+    template<class T, class Alloc = std::allocator<T>>
+    class Stack
+    {
+      struct Node
+      {
+        Node *next;
+        T     value;
+        template<class... Args>
+        Node(Node *n, Args&&... args) : next(n), value(std::forward<Args>(args)...) {};
+      };
+
+      using NodeAlloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+      using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+     public:
+
+      // nodes per slab
+      static constexpr std::size_t slab_nodes = 1024;
+
+      class iterator
+      {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+        explicit iterator(Node *node = nullptr) : node_(node) {};
+        inline reference operator*() const { return node_->value; };
+        inline pointer operator->() const { return &node_->value; };
+        inline iterator& operator++() { node_ = node_->next; return *this; };
+        inline iterator operator++(int) { iterator it(*this); ++*this; return it; };
+        inline bool operator==(const iterator &o) const { return node_ == o.node_; };
+        inline bool operator!=(const iterator &o) const { return node_ != o.node_; };
+       private:
+        Node *node_;
+      }; // iterator
+
+      explicit Stack(const Alloc &alloc = Alloc()) : alloc_(alloc) {};
+
+      Stack(const Stack&) = delete;
+      Stack& operator=(const Stack&) = delete;
+
+      Stack(Stack &&o) noexcept
+       : head_(std::exchange(o.head_, nullptr)),
+         free_(std::exchange(o.free_, nullptr)),
+         cursor_(std::exchange(o.cursor_, nullptr)),
+         limit_(std::exchange(o.limit_, nullptr)),
+         size_(std::exchange(o.size_, 0)),
+         slabs_(std::move(o.slabs_)),
+         alloc_(std::move(o.alloc_))
+       {};
+
+      ~Stack()
+      {
+        clear();
+        for(auto slab : slabs_) NodeTraits::deallocate(alloc_, slab, slab_nodes);
+      } // ~Stack
+
+      // pushes a copy or a moved value onto the front of the stack
+      inline void push(const T &x) { emplace(x); };
+      inline void push(T &&x) { emplace(std::move(x)); };
+
+      // constructs an element in place at the front of the stack
+      template<class... Args>
+      inline T& emplace(Args&&... args)
+      {
+        Node *node = acquire();
+        try
+        {
+          NodeTraits::construct(alloc_, node, head_, std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+          // the element threw:  its node goes back to the free list
+          release(node);
+          throw;
+        }
+        head_ = node;
+        ++size_;
+        return node->value;
+      } // emplace
+
+      // removes the front element, returning false if the stack is empty
+      inline bool pop()
+      {
+        Node *node = head_;
+        if(nullptr == node) return false;
+        head_ = node->next;
+        NodeTraits::destroy(alloc_, node);
+        release(node);
+        --size_;
+        return true;
+      } // pop
+
+      inline T& front() { return head_->value; };
+      inline const T& front() const { return head_->value; };
+
+      inline bool empty() const { return nullptr == head_; };
+      inline std::size_t size() const { return size_; };
+
+      inline iterator begin() { return iterator(head_); };
+      inline iterator end() { return iterator(); };
+
+      // destroys every element, keeping the slabs for reuse
+      inline void clear()
+      {
+        while(pop());
+      } // clear
+
+     private:
+
+      inline Node* acquire()
+      {
+        if(nullptr != free_)
+        {
+          Node *node = free_;
+          free_ = *reinterpret_cast<Node**>(node);
+          return node;
+        }
+        if(cursor_ == limit_)
+        {
+          // make room to record the slab first, so that it cannot be lost
+          slabs_.reserve(slabs_.size() + 1);
+          cursor_ = NodeTraits::allocate(alloc_, slab_nodes);
+          limit_  = cursor_ + slab_nodes;
+          slabs_.push_back(cursor_);
+        }
+        return cursor_++;
+      } // acquire
+
+      inline void release(Node *node)
+      {
+        *reinterpret_cast<Node**>(node) = free_;
+        free_ = node;
+      } // release
+
+      Node *head_   = nullptr;  // front of the stack
+      Node *free_   = nullptr;  // recycled node storage
+      Node *cursor_ = nullptr;  // next unused node of the newest slab
+      Node *limit_  = nullptr;  // end of the newest slab
+      std::size_t size_ = 0;
+      std::vector<Node*> slabs_;
+      NodeAlloc alloc_;
+
+    }; // Stack
+
+    // thin wrappers preserving the C stack API
+
+    template<class T, class A>
+    inline status_t stack_insert_front(Stack<T,A> &stack, const T &object)
+    {
+      stack.push(object);
+      return SUCCESS;
+    } // stack_insert_front
+
+    template<class T, class A>
+    inline status_t stack_remove_front(Stack<T,A> &stack)
+    {
+      stack.pop();
+      return SUCCESS;
+    } // stack_remove_front
+
+    template<class T, class A>
+    inline status_t stack_free(Stack<T,A> &stack)
+    {
+      stack.clear();
+      return SUCCESS;
+    } // stack_free
+
+  } // mock::container
+
+// *EOF*
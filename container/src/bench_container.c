@@ -0,0 +1,607 @@
+/* bench_container.c
+ * Mac Radigan
+ */
+
+  #include "cmap.h"
+  #include "cstack.h"
+  #include "hash.h"
+  #include "map.h"
+  #include "stack.h"
+  #include <math.h>
+  #include <pthread.h>
+  #include <stdatomic.h>
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <stdio.h>
+  #include <string.h>
+  #include <sys/resource.h>
+  #include <time.h>
+  #include <unistd.h>
+
+  /*
+   * container microbenchmark suite
+   *
+   *   usage:  bench_container [-n max_size] [-t max_threads] [-f csv|json]
+   *
+   *   sizes run from 1K by powers of ten up to max_size (at most 100M);
+   *   threaded cases run at 1, 2, 4, ... up to max_threads.  each record
+   *   reports throughput, per-operation latency percentiles (from timed
+   *   batches of BENCH_BATCH operations), heap allocations per operation
+   *   (counted by wrapping malloc at link time) and the peak RSS so far.
+   */
+
+  #define BENCH_BATCH     64          /* operations per latency sample */
+  #define BENCH_MAX_OPS   (1 << 24)   /* cap on timed operations per case */
+  #define BENCH_MAX_SIZE  100000000
+  #define ZIPF_THETA      0.99
+
+  typedef enum format_e
+  {
+    FORMAT_CSV = 0,
+    FORMAT_JSON
+  } format_t;
+
+  static format_t format = FORMAT_CSV;
+
+  /* ------------------------------------------------------------------------
+   * allocation counting, enabled by -Wl,--wrap=malloc,--wrap=calloc,...
+   * ---------------------------------------------------------------------- */
+
+  static _Atomic size_t allocations;
+
+  void *__real_malloc(size_t size);
+  void *__real_calloc(size_t count, size_t size);
+  void *__real_realloc(void *block, size_t size);
+  void *__real_aligned_alloc(size_t align, size_t size);
+
+  void *__wrap_malloc(size_t size)
+  {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+  }
+
+  void *__wrap_calloc(size_t count, size_t size)
+  {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+  }
+
+  void *__wrap_realloc(void *block, size_t size)
+  {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_realloc(block, size);
+  }
+
+  void *__wrap_aligned_alloc(size_t align, size_t size)
+  {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_aligned_alloc(align, size);
+  }
+
+  /* ------------------------------------------------------------------------
+   * timing and reporting
+   * ---------------------------------------------------------------------- */
+
+  static double now(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+  }
+
+  static long peak_rss_kb(void)
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  /* per-operation latencies, one sample per timed batch */
+  typedef struct samples_s
+  {
+    double *ns;
+    size_t  count;
+    size_t  capacity;
+  } samples_t;
+
+  static void samples_make(samples_t *samples, size_t ops)
+  {
+    samples->capacity = ops / BENCH_BATCH + 1;
+    samples->count    = 0;
+    samples->ns       = (double *)malloc(samples->capacity * sizeof(double));
+  }
+
+  static inline void samples_add(samples_t *samples, double seconds, size_t ops)
+  {
+    if(samples->count < samples->capacity && 0 < ops)
+    {
+      samples->ns[samples->count++] = 1e9 * seconds / ops;
+    }
+  }
+
+  static void samples_merge(samples_t *into, const samples_t *from)
+  {
+    for(size_t k=0; k<from->count && into->count<into->capacity; ++k)
+    {
+      into->ns[into->count++] = from->ns[k];
+    }
+  }
+
+  static int compare_double(const void *a, const void *b)
+  {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+  }
+
+  static double percentile(samples_t *samples, double p)
+  {
+    if(0 == samples->count) return 0.0;
+    size_t index = (size_t)(p * (samples->count - 1) + 0.5);
+    return samples->ns[index];
+  }
+
+  typedef struct record_s
+  {
+    const char *structure;
+    const char *operation;
+    const char *distribution;
+    size_t      size;
+    int         threads;
+    size_t      ops;
+    double      seconds;
+    size_t      allocations;
+  } record_t;
+
+  static void report(const record_t *record, samples_t *samples)
+  {
+    qsort(samples->ns, samples->count, sizeof(double), &compare_double);
+    const double ops_per_sec   = record->ops / record->seconds;
+    const double allocs_per_op = (double)record->allocations / record->ops;
+    if(FORMAT_JSON == format)
+    {
+      fprintf(stdout,
+        "{\"structure\":\"%s\",\"operation\":\"%s\",\"distribution\":\"%s\","
+        "\"size\":%zu,\"threads\":%d,\"ops\":%zu,\"ops_per_sec\":%.0f,"
+        "\"ns_p50\":%.2f,\"ns_p90\":%.2f,\"ns_p99\":%.2f,"
+        "\"allocs_per_op\":%.6f,\"peak_rss_kb\":%ld}\n",
+        record->structure, record->operation, record->distribution,
+        record->size, record->threads, record->ops, ops_per_sec,
+        percentile(samples, 0.50), percentile(samples, 0.90), percentile(samples, 0.99),
+        allocs_per_op, peak_rss_kb());
+    }
+    else
+    {
+      fprintf(stdout, "%s,%s,%s,%zu,%d,%zu,%.0f,%.2f,%.2f,%.2f,%.6f,%ld\n",
+        record->structure, record->operation, record->distribution,
+        record->size, record->threads, record->ops, ops_per_sec,
+        percentile(samples, 0.50), percentile(samples, 0.90), percentile(samples, 0.99),
+        allocs_per_op, peak_rss_kb());
+    }
+    fflush(stdout);
+  }
+
+  /* ------------------------------------------------------------------------
+   * key distributions
+   * ---------------------------------------------------------------------- */
+
+  static inline uint64_t xorshift(uint64_t *state)
+  {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+  }
+
+  /* the key stored for the k-th of size elements, scattered over the range */
+  static inline object_t key_of(size_t k)
+  {
+    return (object_t)(k * 2654435761u & 0x7fffffff);
+  }
+
+  /* the constants of a Zipfian (YCSB) draw over [0, size); zetan alone
+   * takes size calls to pow(), and so is computed once per size */
+  typedef struct zipf_s
+  {
+    size_t size;
+    double zetan;
+    double zeta2;
+    double alpha;
+    double eta;
+  } zipf_t;
+
+  static void zipf_make(zipf_t *zipf, size_t size)
+  {
+    zipf->size  = size;
+    zipf->zetan = 0.0;
+    for(size_t i=1; i<=size; ++i) zipf->zetan += 1.0 / pow((double)i, ZIPF_THETA);
+    zipf->zeta2 = 1.0 + pow(0.5, ZIPF_THETA);
+    zipf->alpha = 1.0 / (1.0 - ZIPF_THETA);
+    zipf->eta   = (1.0 - pow(2.0 / size, 1.0 - ZIPF_THETA)) / (1.0 - zipf->zeta2 / zipf->zetan);
+  }
+
+  /* draws ops element indices in [0, size), uniformly, or Zipfian by the
+   * constants of zipf (for the same size) where it is not NULL */
+  static size_t *draw_indices(size_t size, size_t ops, const zipf_t *zipf, uint64_t seed)
+  {
+    size_t *indices = (size_t *)malloc(ops * sizeof(size_t));
+    uint64_t state = seed | 1;
+    if(NULL == zipf)
+    {
+      for(size_t k=0; k<ops; ++k) indices[k] = xorshift(&state) % size;
+      return indices;
+    }
+    for(size_t k=0; k<ops; ++k)
+    {
+      const double u  = (xorshift(&state) >> 11) * (1.0 / 9007199254740992.0);
+      const double uz = u * zipf->zetan;
+      size_t rank;
+      if(uz < 1.0)              rank = 0;
+      else if(uz < zipf->zeta2) rank = 1;
+      else                      rank = (size_t)(size * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+      if(rank >= size) rank = size - 1;
+      /* scatter the hot ranks over the key space */
+      indices[k] = hash_mix64(rank) % size;
+    }
+    return indices;
+  }
+
+  /* ------------------------------------------------------------------------
+   * stack
+   * ---------------------------------------------------------------------- */
+
+  static status_t sum_visit(const object_t *object, void *context)
+  {
+    *(long long *)context += *object;
+    return SUCCESS;
+  }
+
+  volatile long long sink;
+
+  static void bench_stack(const char *structure, status_t (*make)(stack_t *), size_t size)
+  {
+    stack_t stack;
+    make(&stack);
+    samples_t samples;
+    samples_make(&samples, size);
+    record_t record = { structure, "push", "sequential", size, 1, size, 0.0, 0 };
+
+    size_t before = atomic_load(&allocations);
+    double start = now();
+    for(size_t base=0; base<size; base+=BENCH_BATCH)
+    {
+      const size_t n = (size - base < BENCH_BATCH) ? size - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t x = (object_t)k;
+        stack_insert_front(&stack, &x);
+      }
+      samples_add(&samples, now() - t0, n);
+    }
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    report(&record, &samples);
+
+    long long sum = 0;
+    samples.count = 0;
+    before = atomic_load(&allocations);
+    start = now();
+    stack_visit(&stack, &sum_visit, &sum);
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    record.operation   = "iterate";
+    samples_add(&samples, record.seconds, size);
+    report(&record, &samples);
+
+    samples.count = 0;
+    before = atomic_load(&allocations);
+    start = now();
+    for(size_t base=0; base<size; base+=BENCH_BATCH)
+    {
+      const size_t n = (size - base < BENCH_BATCH) ? size - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=0; k<n; ++k)
+      {
+        sum += *stack_front(&stack);
+        stack_remove_front(&stack);
+      }
+      samples_add(&samples, now() - t0, n);
+    }
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    record.operation   = "pop";
+    report(&record, &samples);
+    sink = sum;
+
+    free(samples.ns);
+    stack_free(&stack);
+  }
+
+  /* ------------------------------------------------------------------------
+   * threaded cases
+   * ---------------------------------------------------------------------- */
+
+  typedef struct worker_s
+  {
+    pthread_t          thread;
+    pthread_barrier_t *barrier;
+    void              *container;
+    const size_t      *indices;   /* keys to visit, for maps */
+    size_t             ops;
+    samples_t          samples;
+    double             start;
+    double             stop;
+  } worker_t;
+
+  static void *cstack_worker(void *argument)
+  {
+    worker_t *self = (worker_t *)argument;
+    cstack_t *stack = (cstack_t *)self->container;
+    long long sum = 0;
+    pthread_barrier_wait(self->barrier);
+    self->start = now();
+    /* an op is a push followed by a pop, as counted by record.ops */
+    for(size_t base=0; base<self->ops; base+=BENCH_BATCH)
+    {
+      const size_t n = (self->ops - base < BENCH_BATCH) ? self->ops - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t x = (object_t)k, y;
+        cstack_push(stack, &x);
+        if(SUCCESS == cstack_pop(stack, &y)) sum += y;
+      }
+      samples_add(&self->samples, now() - t0, n);
+    }
+    self->stop = now();
+    sink = sum;
+    return NULL;
+  }
+
+  static void *cmap_get_worker(void *argument)
+  {
+    worker_t *self = (worker_t *)argument;
+    cmap_t *map = (cmap_t *)self->container;
+    long long sum = 0;
+    pthread_barrier_wait(self->barrier);
+    self->start = now();
+    for(size_t base=0; base<self->ops; base+=BENCH_BATCH)
+    {
+      const size_t n = (self->ops - base < BENCH_BATCH) ? self->ops - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t key = key_of(self->indices[k]), value;
+        if(SUCCESS == cmap_get(map, &key, &value)) sum += value;
+      }
+      samples_add(&self->samples, now() - t0, n);
+    }
+    self->stop = now();
+    sink = sum;
+    return NULL;
+  }
+
+  static void *cmap_churn_worker(void *argument)
+  {
+    worker_t *self = (worker_t *)argument;
+    cmap_t *map = (cmap_t *)self->container;
+    pthread_barrier_wait(self->barrier);
+    self->start = now();
+    for(size_t base=0; base<self->ops; base+=BENCH_BATCH)
+    {
+      const size_t n = (self->ops - base < BENCH_BATCH) ? self->ops - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t key = key_of(self->indices[k]);
+        if(SUCCESS == cmap_remove(map, &key)) cmap_insert(map, &key, &key);
+      }
+      samples_add(&self->samples, now() - t0, n);
+    }
+    self->stop = now();
+    return NULL;
+  }
+
+  /* runs worker on threads threads, splitting ops among them */
+  static void run_threads(record_t *record, void *(*worker)(void *), void *container,
+                          const size_t *indices, int threads)
+  {
+    worker_t *workers = (worker_t *)calloc(threads, sizeof(worker_t));
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, threads);
+    const size_t share = record->ops / threads;
+    for(int t=0; t<threads; ++t)
+    {
+      workers[t].barrier   = &barrier;
+      workers[t].container = container;
+      workers[t].indices   = (NULL == indices) ? NULL : indices + t * share;
+      workers[t].ops       = share;
+      samples_make(&workers[t].samples, share);
+    }
+    samples_t samples;
+    samples_make(&samples, record->ops);
+    /* NB:  includes any allocations made by thread creation */
+    const size_t before = atomic_load(&allocations);
+    for(int t=0; t<threads; ++t)
+    {
+      pthread_create(&workers[t].thread, NULL, worker, &workers[t]);
+    }
+    double start = 0, stop = 0;
+    for(int t=0; t<threads; ++t)
+    {
+      pthread_join(workers[t].thread, NULL);
+      if(0 == t || workers[t].start < start) start = workers[t].start;
+      if(0 == t || workers[t].stop > stop)   stop  = workers[t].stop;
+      samples_merge(&samples, &workers[t].samples);
+      free(workers[t].samples.ns);
+    }
+    record->ops         = share * threads;
+    record->threads     = threads;
+    record->seconds     = stop - start;
+    record->allocations = atomic_load(&allocations) - before;
+    report(record, &samples);
+    free(samples.ns);
+    pthread_barrier_destroy(&barrier);
+    free(workers);
+  }
+
+  static void bench_cstack(size_t size, int threads)
+  {
+    cstack_t stack;
+    cstack_make(&stack, (size_t)threads * BENCH_BATCH + 1);
+    record_t record = { "cstack", "push_pop", "sequential", size, threads, size, 0.0, 0 };
+    run_threads(&record, &cstack_worker, &stack, NULL, threads);
+    cstack_free(&stack);
+  }
+
+  /* ------------------------------------------------------------------------
+   * map
+   * ---------------------------------------------------------------------- */
+
+  static void bench_map(size_t size, const zipf_t *zipf)
+  {
+    const char *distribution = zipf ? "zipfian" : "uniform";
+    const size_t ops = (size < BENCH_MAX_OPS) ? size : BENCH_MAX_OPS;
+    size_t *indices = draw_indices(size, ops, zipf, 0x9E3779B97F4A7C15ULL);
+    map_t map;
+    map_make(&map, 0);
+    samples_t samples;
+    samples_make(&samples, size);
+    record_t record = { "map", "insert", "sequential", size, 1, size, 0.0, 0 };
+
+    /* inserts always visit every key once, growing from an empty map */
+    size_t before = atomic_load(&allocations);
+    double start = now();
+    for(size_t base=0; base<size; base+=BENCH_BATCH)
+    {
+      const size_t n = (size - base < BENCH_BATCH) ? size - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t key = key_of(k);
+        map_insert(&map, &key, &key);
+      }
+      samples_add(&samples, now() - t0, n);
+    }
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    if(NULL == zipf) report(&record, &samples);
+
+    long long sum = 0;
+    record.operation    = "get";
+    record.distribution = distribution;
+    record.ops          = ops;
+    samples.count       = 0;
+    before = atomic_load(&allocations);
+    start = now();
+    for(size_t base=0; base<ops; base+=BENCH_BATCH)
+    {
+      const size_t n = (ops - base < BENCH_BATCH) ? ops - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t key = key_of(indices[k]);
+        sum += *map_get(&map, &key);
+      }
+      samples_add(&samples, now() - t0, n);
+    }
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    report(&record, &samples);
+    sink = sum;
+
+    /* removals are paired with a reinsert so the map keeps its size */
+    record.operation = "remove";
+    samples.count    = 0;
+    before = atomic_load(&allocations);
+    start = now();
+    for(size_t base=0; base<ops; base+=BENCH_BATCH)
+    {
+      const size_t n = (ops - base < BENCH_BATCH) ? ops - base : BENCH_BATCH;
+      const double t0 = now();
+      for(size_t k=base; k<base+n; ++k)
+      {
+        object_t key = key_of(indices[k]);
+        if(SUCCESS == map_remove(&map, &key)) map_insert(&map, &key, &key);
+      }
+      samples_add(&samples, now() - t0, n);
+    }
+    record.seconds     = now() - start;
+    record.allocations = atomic_load(&allocations) - before;
+    report(&record, &samples);
+
+    free(samples.ns);
+    free(indices);
+    map_free(&map);
+  }
+
+  static void bench_cmap(size_t size, const zipf_t *zipf, int threads)
+  {
+    const char *distribution = zipf ? "zipfian" : "uniform";
+    const size_t ops = (size < BENCH_MAX_OPS) ? size : BENCH_MAX_OPS;
+    size_t *indices = draw_indices(size, ops, zipf, 0xD1B54A32D192ED03ULL);
+    cmap_t map;
+    cmap_make(&map, size, 64);
+    for(size_t k=0; k<size; ++k)
+    {
+      object_t key = key_of(k);
+      cmap_insert(&map, &key, &key);
+    }
+    record_t record = { "cmap", "get", distribution, size, threads, ops, 0.0, 0 };
+    run_threads(&record, &cmap_get_worker, &map, indices, threads);
+    record.operation = "remove";
+    record.ops       = ops;
+    run_threads(&record, &cmap_churn_worker, &map, indices, threads);
+    free(indices);
+    cmap_free(&map);
+  }
+
+  /*
+   * main benchmark driver
+   */
+  int main(int argc, char *argv[])
+  {
+    size_t max_size = 1000000;
+    int max_threads = 4;
+    int option;
+    while(-1 != (option = getopt(argc, argv, "n:t:f:")))
+    {
+      switch(option)
+      {
+        case 'n': max_size    = strtoull(optarg, NULL, 10);           break;
+        case 't': max_threads = atoi(optarg);                          break;
+        case 'f': format = strcmp(optarg, "json") ? FORMAT_CSV : FORMAT_JSON; break;
+        default:
+          fprintf(stderr, "usage: %s [-n max_size] [-t max_threads] [-f csv|json]\n", argv[0]);
+          return EXIT_FAILURE;
+      }
+    }
+    if(max_size > BENCH_MAX_SIZE) max_size = BENCH_MAX_SIZE;
+
+    if(FORMAT_CSV == format)
+    {
+      fprintf(stdout, "structure,operation,distribution,size,threads,ops,"
+                      "ops_per_sec,ns_p50,ns_p90,ns_p99,allocs_per_op,peak_rss_kb\n");
+    }
+    for(size_t size=1000; size<=max_size; size*=10)
+    {
+      bench_stack("stack",          &stack_make,          size);
+      bench_stack("stack_unrolled", &stack_make_unrolled, size);
+      for(int threads=1; threads<=max_threads; threads*=2) bench_cstack(size, threads);
+      zipf_t zipf;
+      zipf_make(&zipf, size);
+      bench_map(size, NULL);
+      bench_map(size, &zipf);
+      for(int threads=1; threads<=max_threads; threads*=2)
+      {
+        bench_cmap(size, NULL, threads);
+        bench_cmap(size, &zipf, threads);
+      }
+    }
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
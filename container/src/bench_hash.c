@@ -0,0 +1,125 @@
+/* bench_hash.c
+ * Mac Radigan
+ */
+
+  #include "hash.h"
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <stdio.h>
+  #include <string.h>
+  #include <time.h>
+
+  #define KEYS         (1 << 22)
+  #define BUCKET_BITS  16
+  #define SHARD_BITS   4
+
+  typedef hashcode_t (*bench_fn_t)(const void *buf, size_t size);
+
+  static hashcode_t bench_djb2(const void *buf, size_t size)
+  {
+    return hash_djb2(buf, size);
+  }
+
+  static hashcode_t bench_bytes(const void *buf, size_t size)
+  {
+    return hash_bytes(buf, size, 0);
+  }
+
+  static hashcode_t bench_mix64(const void *buf, size_t size)
+  {
+    (void)size; /* a fixed-width key, whatever the buffer size */
+    return hash_mix64((uint64_t)*(const element_t *)buf);
+  }
+
+  static double now(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+  }
+
+  volatile hashcode_t sink;
+
+  /* hashes count keys of the given size laid out back to back */
+  static void bench_throughput(const char *name, bench_fn_t fn,
+                               const unsigned char *keys, size_t size, size_t count)
+  {
+    hashcode_t accumulator = 0;
+    const double start = now();
+    for(size_t k=0; k<count; ++k) accumulator ^= fn(keys + k*size, size);
+    const double elapsed = now() - start;
+    sink = accumulator;
+    fprintf(stdout, "throughput,%s,%zu,hashes_per_sec,%.0f\n", name, size, count / elapsed);
+    fprintf(stdout, "throughput,%s,%zu,bytes_per_sec,%.0f\n", name, size, count * size / elapsed);
+  }
+
+  /* chi-square per degree of freedom (ideally near one) and worst bucket,
+   *   for the low bits (bucket selection) and high bits (shard selection) */
+  static void bench_distribution(const char *name, bench_fn_t fn,
+                                 const char *pattern, element_t stride)
+  {
+    const size_t buckets = (size_t)1 << BUCKET_BITS;
+    const size_t shards  = (size_t)1 << SHARD_BITS;
+    size_t *low  = (size_t *)calloc(buckets, sizeof(size_t));
+    size_t *high = (size_t *)calloc(shards, sizeof(size_t));
+    for(size_t k=0; k<KEYS; ++k)
+    {
+      const element_t key = (element_t)(k * stride);
+      const hashcode_t hashcode = fn(&key, sizeof(key));
+      ++low[hashcode & (buckets - 1)];
+      ++high[(uint64_t)hashcode >> (64 - SHARD_BITS)];
+    }
+    double chi2_low = 0, chi2_high = 0;
+    size_t worst = 0;
+    const double expect_low  = (double)KEYS / buckets;
+    const double expect_high = (double)KEYS / shards;
+    for(size_t b=0; b<buckets; ++b)
+    {
+      chi2_low += (low[b] - expect_low) * (low[b] - expect_low) / expect_low;
+      if(low[b] > worst) worst = low[b];
+    }
+    for(size_t s=0; s<shards; ++s)
+    {
+      chi2_high += (high[s] - expect_high) * (high[s] - expect_high) / expect_high;
+    }
+    fprintf(stdout, "distribution,%s,%s,bucket_chi2_per_df,%.3f\n", name, pattern, chi2_low / (buckets - 1));
+    fprintf(stdout, "distribution,%s,%s,bucket_max_over_mean,%.3f\n", name, pattern, worst / expect_low);
+    fprintf(stdout, "distribution,%s,%s,shard_chi2_per_df,%.3f\n", name, pattern, chi2_high / (shards - 1));
+    free(low);
+    free(high);
+  }
+
+  /*
+   * main benchmark driver
+   */
+  int main(int argc, char *argv[])
+  {
+    const size_t sizes[] = { sizeof(element_t), 16, 64, 256, 4096 };
+    const size_t budget  = (size_t)KEYS * 16; /* bytes of keys per run */
+    unsigned char *keys = (unsigned char *)malloc(budget);
+    for(size_t k=0; k<budget; ++k) keys[k] = (unsigned char)(rand() >> 7);
+
+    fprintf(stdout, "benchmark,hash,parameter,metric,value\n");
+    bench_throughput("mix64", &bench_mix64, keys, sizeof(element_t), KEYS);
+    for(size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+      const size_t count = budget / sizes[s];
+      bench_throughput("djb2",  &bench_djb2,  keys, sizes[s], count);
+      bench_throughput("bytes", &bench_bytes, keys, sizes[s], count);
+    }
+
+    const char *patterns[] = { "sequential", "stride_1024" };
+    const element_t strides[] = { 1, 1024 };
+    for(size_t p=0; p<2; ++p)
+    {
+      bench_distribution("djb2",  &bench_djb2,  patterns[p], strides[p]);
+      bench_distribution("mix64", &bench_mix64, patterns[p], strides[p]);
+      bench_distribution("bytes", &bench_bytes, patterns[p], strides[p]);
+    }
+
+    free(keys);
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
@@ -0,0 +1,74 @@
+/* bench_map.c
+ * Mac Radigan
+ */
+
+  #include "map.h"
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <stdio.h>
+  #include <time.h>
+
+  #define LOOKUPS (1 << 22)
+  #define WINDOW  256
+
+  static double now(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+  }
+
+  volatile object_t sink;
+
+  /* compares one-at-a-time and batched lookups of random present keys */
+  static void bench_lookup(size_t size)
+  {
+    map_t map;
+    map_make(&map, size);
+    object_t *keys   = (object_t *)malloc(size * sizeof(object_t));
+    object_t *probes = (object_t *)malloc(LOOKUPS * sizeof(object_t));
+    object_t **found = (object_t **)malloc(WINDOW * sizeof(object_t *));
+    for(size_t k=0; k<size; ++k) keys[k] = (object_t)k;
+    map_insert_batch(&map, keys, keys, size);
+    uint64_t state = 88172645463325252ULL;
+    for(size_t k=0; k<LOOKUPS; ++k)
+    {
+      state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+      probes[k] = (object_t)(state % size);
+    }
+
+    object_t accumulator = 0;
+    double start = now();
+    for(size_t k=0; k<LOOKUPS; ++k) accumulator += *map_get(&map, &probes[k]);
+    const double single = now() - start;
+
+    /* consume results in windows, as a caller would, while still cached */
+    start = now();
+    for(size_t base=0; base<LOOKUPS; base+=WINDOW)
+    {
+      map_get_batch(&map, &probes[base], found, WINDOW);
+      for(size_t k=0; k<WINDOW; ++k) accumulator += *found[k];
+    }
+    const double batch = now() - start;
+    sink = accumulator;
+
+    fprintf(stdout, "map_get,%zu,ops_per_sec,%.0f\n", size, LOOKUPS / single);
+    fprintf(stdout, "map_get_batch,%zu,ops_per_sec,%.0f\n", size, LOOKUPS / batch);
+    free(found);
+    free(probes);
+    free(keys);
+    map_free(&map);
+  }
+
+  /*
+   * main benchmark driver
+   */
+  int main(int argc, char *argv[])
+  {
+    fprintf(stdout, "operation,size,metric,value\n");
+    for(size_t size=(size_t)1<<12; size<=(size_t)1<<24; size<<=4) bench_lookup(size);
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
@@ -0,0 +1,73 @@
+/* bench_stack.c
+ * Mac Radigan
+ */
+
+  #include "stack.h"
+  #include <stdlib.h>
+  #include <stdio.h>
+  #include <time.h>
+
+  static double now(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+  }
+
+  static status_t sum_visit(const object_t *object, void *context)
+  {
+    *(long long *)context += *object;
+    return SUCCESS;
+  }
+
+  volatile long long sink;
+
+  /* pushes, iterates and pops size objects, reporting each rate */
+  static void bench_stack(const char *mode, status_t (*make)(stack_t *), size_t size)
+  {
+    stack_t stack;
+    make(&stack);
+    double start = now();
+    for(size_t k=0; k<size; ++k)
+    {
+      object_t x = (object_t)k;
+      stack_insert_front(&stack, &x);
+    }
+    const double push = now() - start;
+
+    long long sum = 0;
+    start = now();
+    stack_visit(&stack, &sum_visit, &sum);
+    const double iterate = now() - start;
+
+    start = now();
+    for(size_t k=0; k<size; ++k)
+    {
+      sum += *stack_front(&stack);
+      stack_remove_front(&stack);
+    }
+    const double pop = now() - start;
+    sink = sum;
+
+    fprintf(stdout, "push,%s,%zu,ops_per_sec,%.0f\n", mode, size, size / push);
+    fprintf(stdout, "iterate,%s,%zu,ops_per_sec,%.0f\n", mode, size, size / iterate);
+    fprintf(stdout, "pop,%s,%zu,ops_per_sec,%.0f\n", mode, size, size / pop);
+    stack_free(&stack);
+  }
+
+  /*
+   * main benchmark driver
+   */
+  int main(int argc, char *argv[])
+  {
+    fprintf(stdout, "operation,mode,size,metric,value\n");
+    for(size_t size=(size_t)1<<12; size<=(size_t)1<<24; size<<=4)
+    {
+      bench_stack("list",     &stack_make,          size);
+      bench_stack("unrolled", &stack_make_unrolled, size);
+    }
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
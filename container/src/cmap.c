@@ -0,0 +1,112 @@
+/* cmap.c
+ * Mac Radigan
+ */
+
+  #include "cmap.h"
+  #include <stddef.h>
+  #include <stdlib.h>
+  #include <string.h>
+
+  /* selects a shard from the high bits of a Fibonacci-remixed hash code */
+  static cmap_shard_t *cmap_shard(cmap_t *map, const hashcode_t hashcode)
+  {
+    if(0 == map->shard_bits) return &map->shards[0];
+    const unsigned long long mixed =
+      (unsigned long long)hashcode * 0x9E3779B97F4A7C15ULL;
+    return &map->shards[mixed >> (64 - map->shard_bits)];
+  }
+
+  /* releases shards [0, made) and the shard array (all of them on free,
+   * those made so far after a failed make) */
+  static status_t cmap_unwind(cmap_t *map, const size_t made)
+  {
+    for(size_t k=0; k<made; ++k)
+    {
+      map_free(&map->shards[k].map);
+      pthread_rwlock_destroy(&map->shards[k].lock);
+    }
+    free(map->shards);
+    map->shards      = NULL;
+    map->shard_count = 0;
+    map->shard_bits  = 0;
+    return FAILURE;
+  }
+
+  status_t cmap_make(cmap_t *map, const size_t size, const size_t shards)
+  {
+    map->shard_bits  = 0;
+    map->shard_count = 1;
+    while(map->shard_count < shards)
+    {
+      map->shard_count <<= 1;
+      ++map->shard_bits;
+    }
+    map->shards = (cmap_shard_t *)
+      aligned_alloc(64, map->shard_count * sizeof(cmap_shard_t));
+    if(NULL == map->shards) return FAILURE;
+    const size_t shard_size = size / map->shard_count + 1;
+    for(size_t k=0; k<map->shard_count; ++k)
+    {
+      if(0 != pthread_rwlock_init(&map->shards[k].lock, NULL))
+      {
+        return cmap_unwind(map, k);
+      }
+      if(SUCCESS != map_make(&map->shards[k].map, shard_size))
+      {
+        pthread_rwlock_destroy(&map->shards[k].lock);
+        return cmap_unwind(map, k);
+      }
+    }
+    return SUCCESS;
+  }
+
+  status_t cmap_free(cmap_t *map)
+  {
+    cmap_unwind(map, map->shard_count);
+    return SUCCESS;
+  }
+
+  status_t cmap_insert(cmap_t *map, object_t *key, object_t *value)
+  {
+    const hashcode_t hashcode = map_hash(&map->shards[0].map, key);
+    cmap_shard_t *shard = cmap_shard(map, hashcode);
+    pthread_rwlock_wrlock(&shard->lock);
+    const status_t status = map_insert_hashed(&shard->map, key, value, hashcode);
+    pthread_rwlock_unlock(&shard->lock);
+    return status;
+  }
+
+  status_t cmap_remove(cmap_t *map, object_t *key)
+  {
+    const hashcode_t hashcode = map_hash(&map->shards[0].map, key);
+    cmap_shard_t *shard = cmap_shard(map, hashcode);
+    pthread_rwlock_wrlock(&shard->lock);
+    const status_t status = map_remove_hashed(&shard->map, key, hashcode);
+    pthread_rwlock_unlock(&shard->lock);
+    return status;
+  }
+
+  status_t cmap_get(cmap_t *map, object_t *key, object_t *value)
+  {
+    const hashcode_t hashcode = map_hash(&map->shards[0].map, key);
+    cmap_shard_t *shard = cmap_shard(map, hashcode);
+    pthread_rwlock_rdlock(&shard->lock);
+    const object_t *candidate = map_get_hashed(&shard->map, key, hashcode);
+    if(NULL != candidate) memcpy(value, candidate, sizeof(object_t));
+    pthread_rwlock_unlock(&shard->lock);
+    return (NULL == candidate) ? FAILURE : SUCCESS;
+  }
+
+  size_t cmap_count(cmap_t *map)
+  {
+    size_t count = 0;
+    for(size_t k=0; k<map->shard_count; ++k)
+    {
+      pthread_rwlock_rdlock(&map->shards[k].lock);
+      count += map_count(&map->shards[k].map);
+      pthread_rwlock_unlock(&map->shards[k].lock);
+    }
+    return count;
+  }
+
+/* EOF */
@@ -3,6 +3,7 @@
  */
 
   #include "common.h"
+  #include "hash.h"
   #include <assert.h>
   #include <errno.h>
   #include <stdlib.h>
@@ -42,18 +43,133 @@
     assert(-1); /* unreachable line */
   }
 
-  /* define application-appropriate copy constructor here */
-  object_t *object_copy(const object_t *object)
+  /* define application-appropriate copy constructor here:  copies source
+   * into the storage at target, which containers hold inline in their cells */
+  void object_copy(object_t *target, const object_t *source)
   {
-    object_t *new_object = (object_t *)malloc(sizeof(object_t));
-    memcpy(new_object, object, sizeof(object_t));
-    return new_object;
+    memcpy(target, source, sizeof(object_t));
   }
 
-  /* define application-appropriate cleanup here */
+  /* define application-appropriate destructor here:  releases whatever the
+   * object owns, but not the object itself, whose storage is a container's
+   * cell (nothing to do for a plain value) */
   void object_free(object_t *object)
   {
-    free(object);
+    (void)object;
+  }
+
+  /* define application-appropriate hash here */
+  hashcode_t object_hash(const object_t *object)
+  {
+    return hash_mix64((uint64_t)*object);
+  }
+
+  /* define application-appropriate cell allocation here */
+  void *object_alloc(pool_t *pool, size_t size)
+  {
+    /* NB:  pooled cells are of the pool's fixed cell size */
+    return (NULL == pool) ? malloc(size) : pool_alloc(pool);
+  }
+
+  /* define application-appropriate cell deallocation here */
+  void object_release(pool_t *pool, void *block)
+  {
+    if(NULL == pool)
+    {
+      free(block);
+    }
+    else
+    {
+      pool_release(pool, block);
+    }
+  }
+
+  status_t pool_make(pool_t *pool, size_t cell_size, size_t slab_cells)
+  {
+    /* cells must hold the free list link and keep their successors aligned */
+    const size_t align = sizeof(void *);
+    if(cell_size < sizeof(void *)) cell_size = sizeof(void *);
+    pool->cell_size  = (cell_size + align - 1) / align * align;
+    pool->slab_cells = (0 == slab_cells) ? 1 : slab_cells;
+    pool->slabs      = NULL;
+    pool->free_list  = NULL;
+    pool->cursor     = NULL;
+    pool->limit      = NULL;
+    pool->live       = 0;
+    pool->slab_count = 0;
+    return SUCCESS;
+  }
+
+  status_t pool_free(pool_t *pool)
+  {
+    slab_t *slab = pool->slabs;
+    while(NULL != slab)
+    {
+      slab_t *next = slab->next;
+      free(slab);
+      slab = next;
+    }
+    pool->slabs      = NULL;
+    pool->free_list  = NULL;
+    pool->cursor     = NULL;
+    pool->limit      = NULL;
+    pool->live       = 0;
+    pool->slab_count = 0;
+    return SUCCESS;
+  }
+
+  status_t pool_reset(pool_t *pool)
+  {
+    /* keep the newest slab for reuse, release the rest in bulk */
+    slab_t *keep = pool->slabs;
+    if(NULL == keep) return SUCCESS;
+    slab_t *slab = keep->next;
+    while(NULL != slab)
+    {
+      slab_t *next = slab->next;
+      free(slab);
+      slab = next;
+    }
+    keep->next       = NULL;
+    pool->free_list  = NULL;
+    pool->cursor     = (char *)(keep + 1);
+    pool->live       = 0;
+    pool->slab_count = 1;
+    return SUCCESS;
+  }
+
+  void *pool_alloc(pool_t *pool)
+  {
+    void *cell = pool->free_list;
+    if(NULL != cell)
+    {
+      pool->free_list = *(void **)cell;
+    }
+    else
+    {
+      if(pool->cursor == pool->limit)
+      {
+        const size_t bytes = pool->cell_size * pool->slab_cells;
+        slab_t *slab = (slab_t *)malloc(sizeof(slab_t) + bytes);
+        if(NULL == slab) return NULL;
+        slab->next   = pool->slabs;
+        pool->slabs  = slab;
+        pool->cursor = (char *)(slab + 1);
+        pool->limit  = pool->cursor + bytes;
+        ++pool->slab_count;
+      }
+      cell = pool->cursor;
+      pool->cursor += pool->cell_size;
+    }
+    ++pool->live;
+    return cell;
+  }
+
+  void pool_release(pool_t *pool, void *cell)
+  {
+    *(void **)cell = pool->free_list;
+    pool->free_list = cell;
+    --pool->live;
   }
 
 /* EOF */
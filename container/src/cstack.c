@@ -0,0 +1,157 @@
+/* cstack.c
+ * Mac Radigan
+ */
+
+  #include "cstack.h"
+  #include <stddef.h>
+  #include <stdlib.h>
+  #include <string.h>
+
+  static inline uint64_t cstack_pack(uint32_t index, uint32_t tag)
+  {
+    return ((uint64_t)tag << 32) | index;
+  }
+
+  static inline uint32_t cstack_index(uint64_t word)
+  {
+    return (uint32_t)word;
+  }
+
+  static inline uint32_t cstack_tag(uint64_t word)
+  {
+    return (uint32_t)(word >> 32);
+  }
+
+  /* exponential backoff after a failed compare-and-swap */
+  static inline unsigned int cstack_backoff(unsigned int spins)
+  {
+    for(unsigned int k=0; k<spins; ++k)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#else
+      atomic_signal_fence(memory_order_seq_cst);
+#endif
+    }
+    return (spins < CSTACK_BACKOFF_LIMIT) ? 2 * spins : spins;
+  }
+
+  static cstack_node_t *lifo_pop(cstack_t *stack, _Atomic uint64_t *head)
+  {
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    for(unsigned int spins=1; ; spins=cstack_backoff(spins))
+    {
+      const uint32_t index = cstack_index(old);
+      if(0 == index) return NULL;
+      cstack_node_t *node = &stack->nodes[index-1];
+      /* node may be popped and recycled concurrently; the tag makes the
+       *   exchange below fail in that case, discarding this stale read */
+      const uint32_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+      const uint64_t top = cstack_pack(next, cstack_tag(old) + 1);
+      if(atomic_compare_exchange_weak_explicit(head, &old, top,
+           memory_order_acquire, memory_order_acquire))
+      {
+        return node;
+      }
+    }
+  }
+
+  static void lifo_push(cstack_t *stack, _Atomic uint64_t *head, cstack_node_t *node)
+  {
+    const uint32_t index = (uint32_t)(node - stack->nodes) + 1;
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+    for(unsigned int spins=1; ; spins=cstack_backoff(spins))
+    {
+      const uint32_t next = cstack_index(old);
+      atomic_store_explicit(&node->next, next, memory_order_relaxed);
+      node->cell.cdr = (0 == next) ? NULL : &stack->nodes[next-1].cell;
+      const uint64_t top = cstack_pack(index, cstack_tag(old) + 1);
+      if(atomic_compare_exchange_weak_explicit(head, &old, top,
+           memory_order_release, memory_order_relaxed))
+      {
+        return;
+      }
+    }
+  }
+
+  status_t cstack_make(cstack_t *stack, const size_t capacity)
+  {
+    stack->methods.compare = &object_compare;
+    stack->methods.copy    = &object_copy;
+    stack->methods.free    = &object_free;
+    stack->methods.print   = &object_print;
+    stack->methods.hash    = &object_hash;
+    stack->methods.alloc   = &object_alloc;
+    stack->methods.release = &object_release;
+    stack->methods.pool    = NULL; /* nodes are preallocated */
+    if(0 == capacity || capacity >= UINT32_MAX) return FAILURE;
+    stack->nodes = (cstack_node_t *)
+      stack->methods.alloc(stack->methods.pool, capacity * sizeof(cstack_node_t));
+    if(NULL == stack->nodes) return FAILURE;
+    stack->capacity = capacity;
+    /* thread every node onto the free list */
+    for(size_t k=0; k<capacity; ++k)
+    {
+      cstack_node_t *node = &stack->nodes[k];
+      node->cell.car = &node->object;
+      node->cell.cdr = NULL;
+      atomic_init(&node->next, (k+1 < capacity) ? (uint32_t)(k+2) : 0);
+    }
+    atomic_init(&stack->head, cstack_pack(0, 0));
+    atomic_init(&stack->free, cstack_pack(1, 0));
+    return SUCCESS;
+  }
+
+  status_t cstack_free(cstack_t *stack)
+  {
+    /* destroys the objects still on the stack, which no thread may now use */
+    const uint32_t index = cstack_index(atomic_load(&stack->head));
+    for(cell_t *cursor = (0 == index) ? NULL : &stack->nodes[index-1].cell;
+        NULL != cursor; cursor = cursor->cdr)
+    {
+      stack->methods.free((object_t *)cursor->car);
+    }
+    stack->methods.release(stack->methods.pool, stack->nodes);
+    stack->nodes    = NULL;
+    stack->capacity = 0;
+    atomic_store(&stack->head, cstack_pack(0, 0));
+    atomic_store(&stack->free, cstack_pack(0, 0));
+    return SUCCESS;
+  }
+
+  status_t cstack_push(cstack_t *stack, const object_t *object)
+  {
+    cstack_node_t *node = lifo_pop(stack, &stack->free);
+    if(NULL == node) return FAILURE; /* stack is at capacity */
+    stack->methods.copy(&node->object, object);
+    lifo_push(stack, &stack->head, node);
+    return SUCCESS;
+  }
+
+  status_t cstack_pop(cstack_t *stack, object_t *object)
+  {
+    cstack_node_t *node = lifo_pop(stack, &stack->head);
+    if(NULL == node) return FAILURE; /* stack is empty */
+    /* the object moves out to the caller, who then owns it */
+    memcpy(object, &node->object, sizeof(object_t));
+    lifo_push(stack, &stack->free, node);
+    return SUCCESS;
+  }
+
+  status_t cstack_print(cstack_t *stack, FILE *stream)
+  {
+    const uint32_t index = cstack_index(atomic_load(&stack->head));
+    cell_t *cursor = (0 == index) ? NULL : &stack->nodes[index-1].cell;
+    fprintf(stream, "( ");
+    for(; NULL != cursor; cursor = cursor->cdr)
+    {
+      stack->methods.print( ((object_t *)cursor->car), stream );
+      fprintf(stream, " ");
+    }
+    fprintf(stream, ")");
+    fprintf(stream, "\n");
+    fflush(stream);
+    return SUCCESS;
+  }
+
+/* EOF */
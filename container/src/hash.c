@@ -0,0 +1,142 @@
+/* hash.c
+ * Mac Radigan
+ */
+
+  #include "hash.h"
+  #include <stddef.h>
+  #include <string.h>
+
+  /* odd constants with well-spread bits (from wyhash and xxh3) */
+  static const uint64_t secret[8] =
+  {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL,
+    0x1d8e4e27c47d124fULL, 0xbe4ba423396cfeb8ULL,
+    0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL
+  };
+
+  static inline uint64_t read64(const unsigned char *p)
+  {
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+  }
+
+  static inline uint64_t read32(const unsigned char *p)
+  {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+  }
+
+  /* multiplies to 128 bits and folds the halves together */
+  static inline uint64_t mum(uint64_t a, uint64_t b)
+  {
+    __extension__ typedef unsigned __int128 uint128_t;
+    const uint128_t product = (uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+  }
+
+  hashcode_t hash_djb2(const void *buf, size_t size)
+  {
+     const unsigned char *bytes = (const unsigned char *)buf;
+     unsigned long hash = 5381;
+     for(size_t k=0; k<size;  ++k)
+     {
+       hash = ((hash << 5) + hash) + bytes[k]; /* hash * 33 + buf[k] */
+     }
+     return hash;
+  }
+
+  hashcode_t hash_mix64(uint64_t x)
+  {
+    /* SplitMix64 finalizer */
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (hashcode_t)x;
+  }
+
+  /* eight independent lanes over whole stripes, vectorizable */
+  static uint64_t hash_stripes(const unsigned char *p, size_t stripes, uint64_t seed)
+  {
+    uint64_t acc[8];
+    for(int i=0; i<8; ++i) acc[i] = secret[i] ^ seed;
+    for(size_t s=0; s<stripes; ++s, p+=HASH_STRIPE)
+    {
+      for(int i=0; i<8; ++i)
+      {
+        const uint64_t data = read64(p + 8*i);
+        const uint64_t keyed = data ^ secret[i];
+        acc[i] += data;
+        acc[i] += (keyed & 0xffffffffULL) * (keyed >> 32);
+      }
+      /* scramble periodically so high lanes do not saturate */
+      if(15 == (s & 15))
+      {
+        for(int i=0; i<8; ++i)
+        {
+          acc[i] ^= acc[i] >> 47;
+          acc[i] *= 0x9E3779B1ULL;
+        }
+      }
+    }
+    uint64_t hash = seed;
+    for(int i=0; i<8; i+=2)
+    {
+      hash ^= mum(acc[i] ^ secret[i], acc[i+1] ^ secret[i+1]);
+    }
+    return hash;
+  }
+
+  hashcode_t hash_bytes(const void *buf, size_t size, uint64_t seed)
+  {
+    const unsigned char *p = (const unsigned char *)buf;
+    uint64_t a, b;
+    seed ^= mum(seed ^ secret[0], secret[1]);
+    if(size <= 16)
+    {
+      if(size >= 4)
+      {
+        /* two overlapping reads from each end cover 4..16 bytes */
+        const size_t shift = (size >> 3) << 2;
+        a = (read32(p) << 32) | read32(p + shift);
+        b = (read32(p + size - 4) << 32) | read32(p + size - 4 - shift);
+      }
+      else if(size > 0)
+      {
+        a = ((uint64_t)p[0] << 16) | ((uint64_t)p[size >> 1] << 8) | p[size - 1];
+        b = 0;
+      }
+      else
+      {
+        a = b = 0;
+      }
+    }
+    else
+    {
+      size_t remaining = size;
+      if(remaining > HASH_STRIPE)
+      {
+        const size_t stripes = (remaining - 1) / HASH_STRIPE;
+        seed ^= hash_stripes(p, stripes, seed);
+        p         += stripes * HASH_STRIPE;
+        remaining -= stripes * HASH_STRIPE;
+      }
+      while(remaining > 16)
+      {
+        seed = mum(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+        p         += 16;
+        remaining -= 16;
+      }
+      a = read64(p + remaining - 16);
+      b = read64(p + remaining - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    return (hashcode_t)mum(secret[1] ^ size, mum(a, b));
+  }
+
+/* EOF */
@@ -3,84 +3,457 @@
  */
 
   #include "map.h"
+  #include "hash.h"
+  #include <fcntl.h>
   #include <stddef.h>
+  #include <stdio.h>
   #include <stdlib.h>
   #include <string.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
 
-  static hashcode_t hash_djb2(const object_t *object, size_t size)
+  /* the key hashed to detect a file saved under a different hash method */
+  static const object_t MAP_FILE_PROBE = 0x5eed;
+
+  static status_t table_make(map_table_t *table, size_t size)
   {
-     const unsigned char *buf = (const unsigned char *)object;
-     unsigned long hash = 5381;
-     int c;
-     for(size_t k=0; k<size;  ++k)
-     {
-       hash = ((hash << 5) + hash) + buf[k]; /* hash * 33 + buf[k] */
-     }
-     return hash;
+    table->slots = (map_slot_t *)calloc(size, sizeof(map_slot_t));
+    table->size  = size;
+    table->count = 0;
+    return (NULL == table->slots) ? FAILURE : SUCCESS;
   }
 
-  status_t map_make(map_t *map, const size_t size)
+  /* empties the descriptor, without freeing slots it may still share */
+  static void table_clear(map_table_t *table)
+  {
+    table->slots = NULL;
+    table->size  = 0;
+    table->count = 0;
+  }
+
+  static void table_free(map_table_t *table)
+  {
+    free(table->slots);
+    table_clear(table);
+  }
+
+  /* returns the slot holding key, or NULL if the key is not in the table */
+  static map_slot_t *table_find(const map_t *map, const map_table_t *table,
+                                const object_t *key, hashcode_t hashcode)
+  {
+    if(0 == table->count) return NULL;
+    const size_t mask = table->size - 1;
+    size_t index = hashcode & mask;
+    for(unsigned int distance=1; ; ++distance)
+    {
+      map_slot_t *slot = &table->slots[index];
+      /* an empty slot, or a slot closer to its home than we are to ours,
+       *   terminates the probe sequence */
+      if(slot->distance < distance) return NULL;
+      if(0 == map->methods.compare(&slot->key, key)) return slot;
+      index = (index + 1) & mask;
+    }
+  }
+
+  /* places a key known to be absent from the table, moving key and value
+   *   into it (the caller constructs them, e.g. by methods.copy) */
+  static void table_place(map_table_t *table, const object_t *key,
+                          const object_t *value, hashcode_t hashcode)
+  {
+    const size_t mask = table->size - 1;
+    size_t index = hashcode & mask;
+    map_slot_t carry;
+    carry.distance = 1;
+    carry.key      = *key;
+    carry.value    = *value;
+    for(;;)
+    {
+      map_slot_t *slot = &table->slots[index];
+      if(0 == slot->distance)
+      {
+        *slot = carry;
+        ++table->count;
+        return;
+      }
+      /* Robin Hood:  take from the rich (near home), give to the poor */
+      if(slot->distance < carry.distance)
+      {
+        map_slot_t displaced = *slot;
+        *slot = carry;
+        carry = displaced;
+      }
+      index = (index + 1) & mask;
+      ++carry.distance;
+    }
+  }
+
+  /* removes an occupied slot by shifting its successors back (no tombstones) */
+  static void table_erase(map_table_t *table, map_slot_t *slot)
+  {
+    const size_t mask = table->size - 1;
+    size_t index = (size_t)(slot - table->slots);
+    for(;;)
+    {
+      const size_t next = (index + 1) & mask;
+      map_slot_t *successor = &table->slots[next];
+      if(successor->distance <= 1) break;
+      table->slots[index] = *successor;
+      --table->slots[index].distance;
+      index = next;
+    }
+    table->slots[index].distance = 0;
+    --table->count;
+  }
+
+  /* moves up to MAP_REHASH_STEP slots of the old table into the active one */
+  static void map_migrate(map_t *map, size_t steps)
+  {
+    if(NULL == map->old.slots) return;
+    while(steps-- > 0 && map->cursor < map->old.size)
+    {
+      map_slot_t *slot = &map->old.slots[map->cursor];
+      if(0 == slot->distance)
+      {
+        ++map->cursor;
+        continue;
+      }
+      const hashcode_t hashcode = map->methods.hash(&slot->key);
+      table_place(&map->table, &slot->key, &slot->value, hashcode);
+      /* erasing shifts the successors back onto the cursor, so the cursor
+       *   only advances on empty slots */
+      table_erase(&map->old, slot);
+    }
+    if(map->cursor >= map->old.size || 0 == map->old.count)
+    {
+      table_free(&map->old);
+      map->cursor = 0;
+    }
+  }
+
+  /* destroys the key and value of every occupied slot of a table */
+  static void table_destroy(const map_t *map, map_table_t *table)
+  {
+    for(size_t k=0; k<table->size; ++k)
+    {
+      map_slot_t *slot = &table->slots[k];
+      if(0 == slot->distance) continue;
+      map->methods.free(&slot->key);
+      map->methods.free(&slot->value);
+    }
+  }
+
+  static size_t map_capacity(size_t size)
+  {
+    return size * MAP_LOAD_NUMERATOR / MAP_LOAD_DENOMINATOR;
+  }
+
+  /* starts an incremental rehash into a table of twice the size */
+  static status_t map_grow(map_t *map)
+  {
+    /* never stack rehashes:  drain any outstanding one first */
+    map_migrate(map, (size_t)-1);
+    map->old = map->table;
+    map->cursor = 0;
+    if(SUCCESS != table_make(&map->table, 2 * map->old.size))
+    {
+      /* the old table is the active one again, and no rehash is pending */
+      map->table = map->old;
+      table_clear(&map->old);
+      return FAILURE;
+    }
+    return SUCCESS;
+  }
+
+  static void map_methods(map_t *map)
   {
     map->methods.compare = &object_compare;
+    map->methods.print   = &object_print;
     map->methods.copy    = &object_copy;
     map->methods.free    = &object_free;
-    map->size            = size;
-    /* NB:  architecture-specific NULL equivalence */
-    map->table = calloc(sizeof(object_t *), size);
-    return SUCCESS;
+    map->methods.hash    = &object_hash;
+    map->methods.alloc   = &object_alloc;
+    map->methods.release = &object_release;
+    map->methods.pool    = NULL; /* keys and values are stored in the table */
+    map->mapping         = NULL;
+    map->mapped          = 0;
+  }
+
+  status_t map_make(map_t *map, const size_t size)
+  {
+    map_methods(map);
+    size_t slots = 8;
+    while(map_capacity(slots) < size) slots <<= 1;
+    table_clear(&map->old);
+    map->cursor    = 0;
+    return table_make(&map->table, slots);
   }
 
   status_t map_free(map_t *map)
   {
-    for(int k=0; k<map->size;  ++k)
+    if(NULL != map->mapping)
     {
-      /* NB:  architecture-specific NULL equivalence */
-      if(NULL != map->table[k])
-      {
-        map->methods.free( *(object_t *)(map->table[k]) );
-      }
+      munmap(map->mapping, map->mapped);
+      map->mapping     = NULL;
+      map->mapped      = 0;
+      map->table.slots = NULL;
+    }
+    /* keys and values of the default type own nothing, and are not visited */
+    else if(&object_free != map->methods.free)
+    {
+      table_destroy(map, &map->table);
+      table_destroy(map, &map->old);
     }
+    table_free(&map->table);
+    table_free(&map->old);
+    map->cursor = 0;
     return SUCCESS;
   }
 
-  status_t map_insert(map_t *map, object_t *key, object_t *value)
+  /* makes room for size keys without rehashing, finishing any rehash */
+  static status_t map_reserve(map_t *map, size_t size)
   {
-    hashcode_t hashcode = hash_djb2(key, sizeof(object_t));
-    const int index = hashcode % map->size;
-    if(NULL != map->table[index])
+    map_migrate(map, (size_t)-1);
+    if(map_capacity(map->table.size) >= size) return SUCCESS;
+    size_t slots = map->table.size;
+    while(map_capacity(slots) < size) slots <<= 1;
+    map->old = map->table;
+    map->cursor = 0;
+    if(SUCCESS != table_make(&map->table, slots))
     {
-      perror("Object already in map.");
+      map->table = map->old;
+      table_clear(&map->old);
       return FAILURE;
     }
-  //map->table[index] = map->methods.copy(value);
-    object_t *object_new = (object_t *)malloc(sizeof(object_t));
-    memcpy(object_new, value, sizeof(object_t));
-    map->table[index] = object_new;
+    map_migrate(map, (size_t)-1);
+    return SUCCESS;
+  }
+
+  static inline void map_prefetch(const map_t *map, hashcode_t hashcode)
+  {
+    __builtin_prefetch(&map->table.slots[hashcode & (map->table.size - 1)]);
+    if(NULL != map->old.slots)
+    {
+      __builtin_prefetch(&map->old.slots[hashcode & (map->old.size - 1)]);
+    }
+  }
+
+  status_t map_insert_hashed(map_t *map, object_t *key, object_t *value,
+                             hashcode_t hashcode)
+  {
+    if(NULL != map->mapping) return FAILURE; /* read-only */
+    if(NULL != table_find(map, &map->table, key, hashcode) ||
+       NULL != table_find(map, &map->old, key, hashcode))
+    {
+      return FAILURE; /* object already in map */
+    }
+    if(map_count(map) + 1 > map_capacity(map->table.size))
+    {
+      if(SUCCESS != map_grow(map)) return FAILURE;
+    }
+    object_t stored_key, stored_value;
+    map->methods.copy(&stored_key, key);
+    map->methods.copy(&stored_value, value);
+    table_place(&map->table, &stored_key, &stored_value, hashcode);
+    map_migrate(map, MAP_REHASH_STEP);
     return SUCCESS;
   }
 
+  object_t *map_get_hashed(map_t *map, object_t *key, hashcode_t hashcode)
+  {
+    map_slot_t *candidate = table_find(map, &map->table, key, hashcode);
+    if(NULL == candidate)
+    {
+      candidate = table_find(map, &map->old, key, hashcode);
+    }
+    return (NULL == candidate) ? NULL : &candidate->value;
+  }
+
+  status_t map_insert(map_t *map, object_t *key, object_t *value)
+  {
+    return map_insert_hashed(map, key, value, map->methods.hash(key));
+  }
+
   status_t map_remove(map_t *map, object_t *key)
   {
-    hashcode_t hashcode = hash_djb2(key, sizeof(object_t));
-    const int index = hashcode % map->size;
-    object_t *candidate = map->table[index];
-    /* NB:  architecture-specific NULL equivalence */
+    return map_remove_hashed(map, key, map->methods.hash(key));
+  }
+
+  status_t map_remove_hashed(map_t *map, object_t *key, hashcode_t hashcode)
+  {
+    if(NULL != map->mapping) return FAILURE; /* read-only */
+    map_table_t *table = &map->table;
+    map_slot_t *candidate = table_find(map, table, key, hashcode);
     if(NULL == candidate)
     {
-      perror("Object not in map.");
-      return FAILURE;
+      table = &map->old;
+      candidate = table_find(map, table, key, hashcode);
     }
-    map->methods.free(candidate);
+    if(NULL == candidate) return FAILURE; /* object not in map */
+    map->methods.free(&candidate->key);
+    map->methods.free(&candidate->value);
+    table_erase(table, candidate);
+    map_migrate(map, MAP_REHASH_STEP);
     return SUCCESS;
   }
 
   object_t *map_get(map_t *map, object_t *key)
   {
-    hashcode_t hashcode = hash_djb2(key, sizeof(object_t));
-    const int index = hashcode % map->size;
-    object_t *candidate = map->table[index];
-    /* NB:  architecture-specific NULL equivalence */
-    return candidate;
+    return map_get_hashed(map, key, map->methods.hash(key));
+  }
+
+  status_t map_insert_batch(map_t *map, object_t *keys, object_t *values, size_t count)
+  {
+    if(NULL != map->mapping) return FAILURE; /* read-only */
+    if(SUCCESS != map_reserve(map, map_count(map) + count)) return FAILURE;
+    status_t status = SUCCESS;
+    hashcode_t hashcodes[MAP_BATCH];
+    for(size_t base=0; base<count; base+=MAP_BATCH)
+    {
+      const size_t n = (count - base < MAP_BATCH) ? count - base : MAP_BATCH;
+      for(size_t k=0; k<n; ++k)
+      {
+        hashcodes[k] = map->methods.hash(&keys[base+k]);
+        map_prefetch(map, hashcodes[k]);
+      }
+      for(size_t k=0; k<n; ++k)
+      {
+        if(SUCCESS != map_insert_hashed(map, &keys[base+k], &values[base+k], hashcodes[k]))
+        {
+          status = FAILURE;
+        }
+      }
+    }
+    return status;
+  }
+
+  size_t map_get_batch(map_t *map, object_t *keys, object_t **values, size_t count)
+  {
+    /* hash and prefetch the next group while resolving the current one */
+    size_t found = 0;
+    hashcode_t hashcodes[2*MAP_BATCH];
+    for(size_t k=0; k<count && k<MAP_BATCH; ++k)
+    {
+      hashcodes[k] = map->methods.hash(&keys[k]);
+      map_prefetch(map, hashcodes[k]);
+    }
+    for(size_t base=0; base<count; base+=MAP_BATCH)
+    {
+      hashcode_t *current = &hashcodes[(base / MAP_BATCH % 2) * MAP_BATCH];
+      hashcode_t *next    = &hashcodes[((base / MAP_BATCH + 1) % 2) * MAP_BATCH];
+      for(size_t k=base+MAP_BATCH; k<count && k<base+2*MAP_BATCH; ++k)
+      {
+        next[k-base-MAP_BATCH] = map->methods.hash(&keys[k]);
+        map_prefetch(map, next[k-base-MAP_BATCH]);
+      }
+      for(size_t k=base; k<count && k<base+MAP_BATCH; ++k)
+      {
+        values[k] = map_get_hashed(map, &keys[k], current[k-base]);
+        if(NULL != values[k]) ++found;
+      }
+    }
+    return found;
+  }
+
+  hashcode_t map_hash(const map_t *map, const object_t *key)
+  {
+    return map->methods.hash(key);
+  }
+
+  size_t map_count(const map_t *map)
+  {
+    return map->table.count + map->old.count;
+  }
+
+  static uint64_t header_checksum(const map_header_t *header)
+  {
+    return hash_bytes(header, offsetof(map_header_t, header_checksum), MAP_FILE_VERSION);
+  }
+
+  status_t map_save(map_t *map, const char *path)
+  {
+    /* a snapshot holds a single table */
+    map_migrate(map, (size_t)-1);
+    const size_t bytes = map->table.size * sizeof(map_slot_t);
+    map_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC));
+    header.version         = MAP_FILE_VERSION;
+    header.slot_size       = sizeof(map_slot_t);
+    header.size            = map->table.size;
+    header.count           = map->table.count;
+    header.hash_probe      = map->methods.hash(&MAP_FILE_PROBE);
+    header.slot_checksum   = hash_bytes(map->table.slots, bytes, MAP_FILE_VERSION);
+    header.header_checksum = header_checksum(&header);
+    /* write beside the target and rename, so readers never see a partial file */
+    char temporary[4096];
+    if(snprintf(temporary, sizeof(temporary), "%s.tmp", path) >= (int)sizeof(temporary))
+    {
+      return FAILURE;
+    }
+    FILE *stream = fopen(temporary, "wb");
+    if(NULL == stream) return FAILURE;
+    static const char padding[MAP_FILE_ALIGN];
+    status_t status = SUCCESS;
+    if(1 != fwrite(&header, sizeof(header), 1, stream) ||
+       1 != fwrite(padding, MAP_FILE_ALIGN - sizeof(header), 1, stream) ||
+       1 != fwrite(map->table.slots, bytes, 1, stream))
+    {
+      status = FAILURE;
+    }
+    if(0 != fclose(stream)) status = FAILURE;
+    if(SUCCESS == status && 0 != rename(temporary, path)) status = FAILURE;
+    if(SUCCESS != status) remove(temporary);
+    return status;
+  }
+
+  status_t map_open_mmap(map_t *map, const char *path)
+  {
+    map_methods(map);
+    table_clear(&map->old);
+    table_clear(&map->table);
+    map->cursor    = 0;
+    const int fd = open(path, O_RDONLY);
+    if(0 > fd) return FAILURE;
+    struct stat info;
+    if(0 != fstat(fd, &info) || (size_t)info.st_size < MAP_FILE_ALIGN)
+    {
+      close(fd);
+      return FAILURE;
+    }
+    void *mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(MAP_FAILED == mapping) return FAILURE;
+    const map_header_t *header = (const map_header_t *)mapping;
+    const size_t slots = (size_t)header->size;
+    if(0 != memcmp(header->magic, MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC)) ||
+       MAP_FILE_VERSION != header->version ||
+       sizeof(map_slot_t) != header->slot_size ||
+       header_checksum(header) != header->header_checksum ||
+       0 == slots || 0 != (slots & (slots - 1)) ||
+       (size_t)info.st_size != MAP_FILE_ALIGN + slots * sizeof(map_slot_t) ||
+       map->methods.hash(&MAP_FILE_PROBE) != header->hash_probe)
+    {
+      munmap(mapping, (size_t)info.st_size);
+      return FAILURE;
+    }
+    /* lookups touch scattered buckets:  do not read ahead */
+    posix_madvise(mapping, (size_t)info.st_size, POSIX_MADV_RANDOM);
+    map->mapping     = mapping;
+    map->mapped      = (size_t)info.st_size;
+    map->table.slots = (map_slot_t *)((char *)mapping + MAP_FILE_ALIGN);
+    map->table.size  = slots;
+    map->table.count = (size_t)header->count;
+    return SUCCESS;
+  }
+
+  status_t map_verify(const map_t *map)
+  {
+    if(NULL == map->mapping) return SUCCESS;
+    const map_header_t *header = (const map_header_t *)map->mapping;
+    const size_t bytes = map->table.size * sizeof(map_slot_t);
+    return (hash_bytes(map->table.slots, bytes, MAP_FILE_VERSION) == header->slot_checksum)
+           ? SUCCESS : FAILURE;
   }
 
 /* EOF */
@@ -5,57 +5,214 @@
   #include "stack.h"
   #include <stddef.h>
   #include <stdlib.h>
-  #include <string.h>
 
-  status_t stack_make(stack_t *stack)
+  /* a cell together with the object it holds, allocated as one block */
+  typedef struct stack_node_s
+  {
+    cell_t   cell;
+    object_t object;
+  } stack_node_t;
+
+  static void stack_methods(stack_t *stack)
   {
     stack->methods.compare = &object_compare;
     stack->methods.copy    = &object_copy;
     stack->methods.free    = &object_free;
     stack->methods.print   = &object_print;
+    stack->methods.hash    = &object_hash;
+    stack->methods.alloc   = &object_alloc;
+    stack->methods.release = &object_release;
+    stack->methods.pool    = &stack->pool;
+    stack->head.car = NULL;
+    stack->head.cdr = NULL;
+    stack->spare    = NULL;
+  }
+
+  status_t stack_make(stack_t *stack)
+  {
+    stack_methods(stack);
+    stack->unrolled = FALSE;
+    return pool_make(&stack->pool, sizeof(stack_node_t), STACK_SLAB_CELLS);
+  }
+
+  status_t stack_make_unrolled(stack_t *stack)
+  {
+    stack_methods(stack);
+    stack->unrolled = TRUE;
+    return pool_make(&stack->pool, sizeof(stack_chunk_t), STACK_SLAB_CHUNKS);
+  }
+
+  static status_t free_visit(const object_t *object, void *context)
+  {
+    ((stack_t *)context)->methods.free((object_t *)object);
+    return SUCCESS;
+  }
+
+  /* destroys every object, then releases every cell, keeping one slab of the
+   *   stack's own pool */
+  status_t stack_clear(stack_t *stack)
+  {
+    /* objects of the default type own nothing, and are not visited */
+    if(&object_free != stack->methods.free)
+    {
+      stack_visit(stack, &free_visit, stack);
+    }
+    if(&stack->pool == stack->methods.pool)
+    {
+      /* pooled cells are released in bulk without visiting them */
+      stack->head.cdr = NULL;
+      stack->spare    = NULL;
+      return pool_reset(&stack->pool);
+    }
+    cell_t *cursor = stack->head.cdr;
+    while(NULL != cursor)
+    {
+      cell_t *next = cursor->cdr;
+      stack->methods.release(stack->methods.pool, cursor);
+      cursor = next;
+    }
+    if(NULL != stack->spare)
+    {
+      stack->methods.release(stack->methods.pool, stack->spare);
+    }
     stack->head.cdr = NULL;
+    stack->spare    = NULL;
     return SUCCESS;
   }
 
   status_t stack_free(stack_t *stack)
   {
-    cell_t *cursor = &stack->head;
-    while(NULL != (cursor = cursor->cdr))
+    stack_clear(stack);
+    return pool_free(&stack->pool);
+  }
+
+  static status_t chunk_insert_front(stack_t *stack, object_t *object)
+  {
+    stack_chunk_t *chunk = (stack_chunk_t *)stack->head.cdr;
+    if(NULL == chunk || STACK_CHUNK_OBJECTS == chunk->count)
+    {
+      chunk = stack->spare;
+      if(NULL != chunk)
+      {
+        stack->spare = NULL;
+      }
+      else
+      {
+        chunk = (stack_chunk_t *)
+          stack->methods.alloc(stack->methods.pool, sizeof(stack_chunk_t));
+        if(NULL == chunk) return FAILURE;
+      }
+      chunk->count    = 0;
+      chunk->cell.car = chunk->objects;
+      chunk->cell.cdr = stack->head.cdr;
+      stack->head.cdr = &chunk->cell;
+    }
+    ++chunk->count;
+    stack->methods.copy(&chunk->objects[STACK_CHUNK_OBJECTS - chunk->count], object);
+    return SUCCESS;
+  }
+
+  static status_t chunk_remove_front(stack_t *stack)
+  {
+    stack_chunk_t *chunk = (stack_chunk_t *)stack->head.cdr;
+    if(NULL == chunk) return SUCCESS;
+    stack->methods.free(&chunk->objects[STACK_CHUNK_OBJECTS - chunk->count]);
+    if(0 == --chunk->count)
     {
-      stack->methods.free( ((object_t *)cursor->car) );
+      stack->head.cdr = chunk->cell.cdr;
+      if(NULL == stack->spare)
+      {
+        stack->spare = chunk;
+      }
+      else
+      {
+        stack->methods.release(stack->methods.pool, chunk);
+      }
     }
     return SUCCESS;
   }
 
   status_t stack_insert_front(stack_t *stack, object_t *object)
   {
-    cell_t *cell = (cell_t *)malloc(sizeof(cell_t));
-    cell->car = stack->methods.copy(object);
-    cell->cdr = stack->head.cdr;
-    stack->head.cdr = cell;
+    if(stack->unrolled) return chunk_insert_front(stack, object);
+    stack_node_t *node = (stack_node_t *)
+      stack->methods.alloc(stack->methods.pool, sizeof(stack_node_t));
+    if(NULL == node) return FAILURE;
+    stack->methods.copy(&node->object, object);
+    node->cell.car = &node->object;
+    node->cell.cdr = stack->head.cdr;
+    stack->head.cdr = &node->cell;
     return SUCCESS;
   }
 
   status_t stack_remove_front(stack_t *stack)
   {
+    if(stack->unrolled) return chunk_remove_front(stack);
     cell_t *candidate = stack->head.cdr;
     if(NULL != candidate)
     {
       stack->head.cdr = candidate->cdr;
-      free(candidate);
+      stack->methods.free((object_t *)candidate->car);
+      stack->methods.release(stack->methods.pool, candidate);
     }
     return SUCCESS;
   }
 
-  status_t stack_print(stack_t *stack, FILE *stream)
+  object_t *stack_front(stack_t *stack)
+  {
+    cell_t *cell = stack->head.cdr;
+    if(NULL == cell) return NULL;
+    if(stack->unrolled)
+    {
+      stack_chunk_t *chunk = (stack_chunk_t *)cell;
+      return &chunk->objects[STACK_CHUNK_OBJECTS - chunk->count];
+    }
+    return (object_t *)cell->car;
+  }
+
+  /* applies visit to each object from front to back, stopping on failure */
+  status_t stack_visit(stack_t *stack, visit_fn_t visit, void *context)
   {
     cell_t *cursor = &stack->head;
-    fprintf(stream, "( ");
     while(NULL != (cursor = cursor->cdr))
     {
-      fprintf(stream, "%d ", *((object_t *)cursor->car));
-      //stack->methods.print( ((object_t *)cursor->car), stream );
+      if(stack->unrolled)
+      {
+        stack_chunk_t *chunk = (stack_chunk_t *)cursor;
+        for(size_t k=STACK_CHUNK_OBJECTS-chunk->count; k<STACK_CHUNK_OBJECTS; ++k)
+        {
+          if(SUCCESS != visit(&chunk->objects[k], context)) return FAILURE;
+        }
+      }
+      else
+      {
+        if(SUCCESS != visit((object_t *)cursor->car, context)) return FAILURE;
+      }
     }
+    return SUCCESS;
+  }
+
+  typedef struct print_context_s
+  {
+    print_fn_t print;
+    FILE      *stream;
+  } print_context_t;
+
+  static status_t print_visit(const object_t *object, void *context)
+  {
+    print_context_t *printer = (print_context_t *)context;
+    printer->print(object, printer->stream);
+    fprintf(printer->stream, " ");
+    return SUCCESS;
+  }
+
+  status_t stack_print(stack_t *stack, FILE *stream)
+  {
+    print_context_t printer;
+    printer.print  = stack->methods.print;
+    printer.stream = stream;
+    fprintf(stream, "( ");
+    stack_visit(stack, &print_visit, &printer);
     fprintf(stream, ")");
     fprintf(stream, "\n");
     fflush(stream);
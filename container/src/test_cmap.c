@@ -0,0 +1,92 @@
+/* test_cmap.c
+ * Mac Radigan
+ */
+
+  #include "cmap.h"
+  #include <pthread.h>
+  #include <stdlib.h>
+  #include <stdio.h>
+
+  #define THREADS    4
+  #define ITERATIONS 50000
+
+  typedef struct worker_s
+  {
+    cmap_t   *map;
+    long      id;
+    long      misses; /* lookups that did not find the expected value */
+  } worker_t;
+
+  /* inserts its own key range, then reads it back and removes the odd keys */
+  static void *worker(void *argument)
+  {
+    worker_t *self = (worker_t *)argument;
+    const object_t base = (object_t)(self->id * ITERATIONS);
+    for(object_t k=0; k<ITERATIONS; ++k)
+    {
+      object_t key = base + k;
+      object_t value = -key;
+      if(SUCCESS != cmap_insert(self->map, &key, &value)) ++self->misses;
+    }
+    for(object_t k=0; k<ITERATIONS; ++k)
+    {
+      object_t key = base + k;
+      object_t value;
+      if(SUCCESS != cmap_get(self->map, &key, &value) || -key != value) ++self->misses;
+      if(k%2 && SUCCESS != cmap_remove(self->map, &key)) ++self->misses;
+    }
+    return NULL;
+  }
+
+  /*
+   * main test driver
+   */
+  int main(int argc, char *argv[])
+  {
+    status_t status;
+
+    cmap_t map;
+    size_t size   = 100; /* reserve slots */
+    size_t shards = 16;
+    status = cmap_make(&map, size, shards);
+      check(status, "Could not create map.");
+
+    object_t k1 = 1010;
+    object_t v1 = 1011;
+    status = cmap_insert(&map, &k1, &v1);
+      check(status, "Could not insert item into map.");
+    object_t v1_stored;
+    status = cmap_get(&map, &k1, &v1_stored);
+      check(status, "Could not access item from map.");
+    fprintf(stdout, "%d : %d\n", k1, v1_stored);
+    status = cmap_remove(&map, &k1);
+      check(status, "Could not remove item from map.");
+
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+    for(long t=0; t<THREADS; ++t)
+    {
+      workers[t].map    = &map;
+      workers[t].id     = t;
+      workers[t].misses = 0;
+      pthread_create(&threads[t], NULL, &worker, &workers[t]);
+    }
+    long misses = 0;
+    for(long t=0; t<THREADS; ++t)
+    {
+      pthread_join(threads[t], NULL);
+      misses += workers[t].misses;
+    }
+    const size_t count = cmap_count(&map);
+    fprintf(stdout, "%zu items in %zu shards, %ld misses\n",
+            count, map.shard_count, misses);
+    if(0 != misses || THREADS * ITERATIONS / 2 != count) return EXIT_FAILURE;
+
+    status = cmap_free(&map);
+      check(status, "Could not free map.");
+
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
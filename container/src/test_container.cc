@@ -0,0 +1,109 @@
+// test_container.cc
+// Mac Radigan
+
+  #include "map.hpp"
+  #include "stack.hpp"
+  #include <cstdlib>
+  #include <iostream>
+  #include <memory>
+  #include <stdexcept>
+  #include <string>
+
+  using namespace mock::container;
+
+  // an allocator counting the allocations made through it
+  static std::size_t allocations = 0;
+
+  template<class T>
+  struct CountingAlloc
+  {
+    using value_type = T;
+    CountingAlloc() = default;
+    template<class U> CountingAlloc(const CountingAlloc<U>&) {};
+    inline T* allocate(std::size_t n) { ++allocations; return std::allocator<T>().allocate(n); };
+    inline void deallocate(T *p, std::size_t n) { std::allocator<T>().deallocate(p, n); };
+    template<class U> inline bool operator==(const CountingAlloc<U>&) const { return true; };
+    template<class U> inline bool operator!=(const CountingAlloc<U>&) const { return false; };
+  }; // CountingAlloc
+
+  // an element whose construction throws for a negative argument
+  struct Fussy
+  {
+    int value;
+    explicit Fussy(int x) : value(x) { if(x < 0) throw std::invalid_argument("Fussy"); };
+  }; // Fussy
+
+  //
+  // main test driver
+  //
+  int main(int argc, char *argv[])
+  {
+    status_t status;
+
+    // the C stack API over a statically dispatched stack
+    Stack<element_t> stack;
+    status = stack_insert_front(stack, 101);
+      check(status, "Could not insert item into stack.");
+    status = stack_insert_front(stack, 102);
+      check(status, "Could not insert item into stack.");
+    status = stack_insert_front(stack, 103);
+      check(status, "Could not insert item into stack.");
+    status = stack_remove_front(stack);
+      check(status, "Could not remove item from front of stack.");
+    std::cout << "( ";
+    for(auto &x : stack) std::cout << x << " ";
+    std::cout << ")" << std::endl;
+
+    // move-only elements are constructed in place and moved, never copied
+    Stack<std::unique_ptr<std::string>> owners;
+    for(int k=0; k<10000; ++k) owners.push(std::make_unique<std::string>(std::to_string(k)));
+    for(int k=0; k<5000; ++k) owners.pop();
+    if(5000 != owners.size() || "4999" != *owners.front()) return EXIT_FAILURE;
+
+    // an element that throws on construction returns its node, so that a
+    //   full slab of elements still fits in the first slab
+    Stack<Fussy, CountingAlloc<Fussy>> fussy;
+    bool thrown = false;
+    try { fussy.emplace(-1); } catch(const std::invalid_argument&) { thrown = true; }
+    if(!thrown || 0 != fussy.size()) return EXIT_FAILURE;
+    for(std::size_t k=0; k<fussy.slab_nodes; ++k) fussy.emplace(static_cast<int>(k));
+    if(1 != allocations || fussy.slab_nodes != fussy.size()) return EXIT_FAILURE;
+
+    // the C map API over a statically dispatched map
+    HashMap<element_t, element_t> map(100);
+    for(element_t k=1010; k<=1030; k+=10)
+    {
+      status = map_insert(map, k, k+1);
+        check(status, "Could not insert item into map.");
+      std::cout << k << " : " << *map_get(map, k) << std::endl;
+    }
+    if(SUCCESS == map_insert(map, 1010, 0)) return EXIT_FAILURE;
+
+    // a second key type in the same binary, grown well past its reservation
+    HashMap<std::string, std::string> names;
+    const int n = 100000;
+    for(int k=0; k<n; ++k) names.insert("key" + std::to_string(k), std::to_string(k));
+    for(int k=0; k<n; k+=2) names.remove("key" + std::to_string(k));
+    for(int k=0; k<n; ++k)
+    {
+      auto value = names.get("key" + std::to_string(k));
+      if( (k%2) ? (nullptr == value || *value != std::to_string(k)) : (nullptr != value) )
+      {
+        std::cerr << "Map lookup mismatch for key " << k << "." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << names.size() << " items after " << n << " inserts and "
+              << n/2 << " removals" << std::endl;
+
+    // a moved-from map is empty, and usable again
+    HashMap<std::string, std::string> moved(std::move(names));
+    if(n/2 != moved.size() || 0 != names.size()) return EXIT_FAILURE;
+    if(nullptr != names.get("key1") || names.remove("key1")) return EXIT_FAILURE;
+    for(int k=0; k<100; ++k) names.insert("key" + std::to_string(k), std::to_string(k));
+    if(100 != names.size() || "99" != *names.get("key99")) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
@@ -0,0 +1,116 @@
+/* test_cstack.c
+ * Mac Radigan
+ */
+
+  #include "cstack.h"
+  #include <pthread.h>
+  #include <stdlib.h>
+  #include <stdio.h>
+
+  #define THREADS    4
+  #define ITERATIONS 100000
+
+  typedef struct worker_s
+  {
+    cstack_t *stack;
+    long      id;
+    long long sum;    /* sum of objects popped */
+  } worker_t;
+
+  /* a free hook that counts the objects destroyed */
+  static size_t frees = 0;
+  static void free_counted(object_t *object)
+  {
+    (void)object;
+    ++frees;
+  }
+
+  /* pushes and pops in alternation, accumulating what it pops */
+  static void *worker(void *argument)
+  {
+    worker_t *self = (worker_t *)argument;
+    for(long k=0; k<ITERATIONS; ++k)
+    {
+      object_t x = (object_t)(self->id * ITERATIONS + k);
+      while(SUCCESS != cstack_push(self->stack, &x));
+      object_t y;
+      if(SUCCESS == cstack_pop(self->stack, &y)) self->sum += y;
+    }
+    return NULL;
+  }
+
+  /*
+   * main test driver
+   */
+  int main(int argc, char *argv[])
+  {
+    status_t status;
+
+    cstack_t stack;
+    status = cstack_make(&stack, 64);
+      check(status, "Could not create stack.");
+
+    object_t x1 = 101;
+    status = cstack_push(&stack, &x1);
+      check(status, "Could not push item onto stack.");
+
+    object_t x2 = 102;
+    status = cstack_push(&stack, &x2);
+      check(status, "Could not push item onto stack.");
+
+    object_t x3 = 103;
+    status = cstack_push(&stack, &x3);
+      check(status, "Could not push item onto stack.");
+
+    object_t y;
+    status = cstack_pop(&stack, &y);
+      check(status, "Could not pop item from stack.");
+
+    status = cstack_print(&stack, stdout);
+      check(status, "Could not print stack.");
+
+    /* every object pushed is popped exactly once across all threads */
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+    for(long t=0; t<THREADS; ++t)
+    {
+      workers[t].stack = &stack;
+      workers[t].id    = t;
+      workers[t].sum   = 0;
+      pthread_create(&threads[t], NULL, &worker, &workers[t]);
+    }
+    long long popped = y;
+    for(long t=0; t<THREADS; ++t)
+    {
+      pthread_join(threads[t], NULL);
+      popped += workers[t].sum;
+    }
+    while(SUCCESS == cstack_pop(&stack, &y)) popped += y;
+    long long pushed = x1 + x2 + x3;
+    for(long long k=0; k<(long long)THREADS*ITERATIONS; ++k) pushed += k;
+    fprintf(stdout, "pushed %lld, popped %lld\n", pushed, popped);
+    if(pushed != popped) return EXIT_FAILURE;
+
+    status = cstack_free(&stack);
+      check(status, "Could not free stack.");
+
+    /* objects popped move out to the caller; those left are destroyed */
+    status = cstack_make(&stack, 64);
+      check(status, "Could not create stack.");
+    stack.methods.free = &free_counted;
+    for(object_t k=0; k<10; ++k)
+    {
+      status = cstack_push(&stack, &k);
+        check(status, "Could not push item onto stack.");
+    }
+    status = cstack_pop(&stack, &y);
+      check(status, "Could not pop item from stack.");
+    status = cstack_free(&stack);
+      check(status, "Could not free stack.");
+    if(9 != frees) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+
+  } // main
+
+// *EOF*
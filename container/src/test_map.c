@@ -6,6 +6,94 @@
   #include <stdlib.h>
   #include <stdio.h>
 
+  /*
+   * calloc is wrapped (-Wl,--wrap=calloc) so that table allocations can be
+   *   made to fail on demand
+   */
+  static int fail_calloc = 0;
+
+  void *__real_calloc(size_t count, size_t size);
+
+  void *__wrap_calloc(size_t count, size_t size)
+  {
+    return fail_calloc ? NULL : __real_calloc(count, size);
+  }
+
+  /* copy and free hooks that count their calls */
+  static size_t copies = 0, frees = 0;
+  static void copy_counted(object_t *target, const object_t *source)
+  {
+    *target = *source;
+    ++copies;
+  }
+  static void free_counted(object_t *object)
+  {
+    (void)object;
+    ++frees;
+  }
+
+  /* keys and values are constructed once on insert, not on rehashing, and
+   *   destroyed once on removal or when the map is freed */
+  static status_t test_hooks(void)
+  {
+    map_t map;
+    if(SUCCESS != map_make(&map, 0)) return FAILURE;
+    map.methods.copy = &copy_counted;
+    map.methods.free = &free_counted;
+    const object_t n = 1000;
+    for(object_t k=0; k<n; ++k)
+    {
+      object_t value = -k;
+      if(SUCCESS != map_insert(&map, &k, &value)) return FAILURE;
+    }
+    if(2 * (size_t)n != copies) return FAILURE;
+    for(object_t k=0; k<n; k+=2)
+    {
+      if(SUCCESS != map_remove(&map, &k)) return FAILURE;
+    }
+    if((size_t)n != frees) return FAILURE;
+    if(SUCCESS != map_free(&map)) return FAILURE;
+    return (2 * (size_t)n == frees) ? SUCCESS : FAILURE;
+  }
+
+  /* a failed growth leaves the map as it was, and usable */
+  static status_t test_grow_failure(void)
+  {
+    map_t map;
+    if(SUCCESS != map_make(&map, 0)) return FAILURE;
+    /* fill to the load factor, so that the next insert must grow */
+    object_t k = 0;
+    for(; map_count(&map) < map.table.size * MAP_LOAD_NUMERATOR / MAP_LOAD_DENOMINATOR; ++k)
+    {
+      object_t value = -k;
+      if(SUCCESS != map_insert(&map, &k, &value)) return FAILURE;
+    }
+    const size_t count = map_count(&map);
+    fail_calloc = 1;
+    object_t value = -k;
+    const status_t grown = map_insert(&map, &k, &value);
+    fail_calloc = 0;
+    if(SUCCESS == grown || count != map_count(&map)) return FAILURE;
+    object_t absent = k;
+    if(NULL != map_get(&map, &absent)) return FAILURE;
+    if(SUCCESS == map_remove(&map, &absent)) return FAILURE;
+    for(object_t j=0; j<k; ++j)
+    {
+      object_t *stored = map_get(&map, &j);
+      if(NULL == stored || -j != *stored) return FAILURE;
+    }
+    /* a batch that cannot be reserved is refused, leaving the map usable */
+    object_t keys[2] = { k, k + 1 }, values[2] = { 0, 0 };
+    fail_calloc = 1;
+    const status_t reserved = map_insert_batch(&map, keys, values, 2);
+    fail_calloc = 0;
+    if(SUCCESS == reserved || count != map_count(&map)) return FAILURE;
+    if(NULL != map_get(&map, &absent)) return FAILURE;
+    /* and grows once allocation succeeds again */
+    if(SUCCESS != map_insert(&map, &k, &value) || count + 1 != map_count(&map)) return FAILURE;
+    return map_free(&map);
+  }
+
   /*
    * main test driver
    */
@@ -42,6 +130,102 @@
       check(status, "Could not access item from list.");
     fprintf(stdout, "%d : %d\n", k3, v3_stored);
 
+    status = map_insert(&map, &k3, &v1);
+    if(SUCCESS == status)
+    {
+      fprintf(stderr, "Duplicate key accepted.\n");
+      return EXIT_FAILURE;
+    }
+
+    /* grow well past the reserved size to exercise collisions and rehashing */
+    const object_t n = 100000;
+    for(object_t k=0; k<n; ++k)
+    {
+      object_t key   = 7 * k;
+      object_t value = k;
+      status = map_insert(&map, &key, &value);
+        check(status, "Could not insert item into map.");
+    }
+    for(object_t k=0; k<n; k+=2)
+    {
+      object_t key = 7 * k;
+      status = map_remove(&map, &key);
+        check(status, "Could not remove item from map.");
+    }
+    for(object_t k=0; k<n; ++k)
+    {
+      object_t key = 7 * k;
+      object_t *value = map_get(&map, &key);
+      if( (k%2) ? (NULL == value || *value != k) : (NULL != value) )
+      {
+        fprintf(stderr, "Map lookup mismatch for key %d.\n", key);
+        return EXIT_FAILURE;
+      }
+    }
+    fprintf(stdout, "%zu items after %d inserts and %d removals\n",
+            map_count(&map), n, n/2);
+
+    /* batch operations agree with the single-key ones */
+    object_t keys[1000], values[1000], *stored[1000];
+    for(object_t k=0; k<1000; ++k)
+    {
+      keys[k]   = -1 - k;
+      values[k] = 2 * k;
+    }
+    status = map_insert_batch(&map, keys, values, 1000);
+      check(status, "Could not insert batch into map.");
+    keys[999] = 14; /* removed above */
+    const size_t found = map_get_batch(&map, keys, stored, 1000);
+    if(999 != found || NULL != stored[999] || 2 * 500 != *stored[500])
+    {
+      fprintf(stderr, "Map batch lookup mismatch.\n");
+      return EXIT_FAILURE;
+    }
+    fprintf(stdout, "%zu of 1000 keys found by batch lookup\n", found);
+
+    /* a saved map is queried in place through a read-only mapping */
+    status = map_save(&map, "test_map.map");
+      check(status, "Could not save map.");
+    map_t mapped;
+    status = map_open_mmap(&mapped, "test_map.map");
+      check(status, "Could not map saved map.");
+    status = map_verify(&mapped);
+      check(status, "Saved map failed verification.");
+    for(object_t k=0; k<n; ++k)
+    {
+      object_t key = 7 * k;
+      object_t *value = map_get(&mapped, &key);
+      if( (k%2) ? (NULL == value || *value != k) : (NULL != value) )
+      {
+        fprintf(stderr, "Mapped lookup mismatch for key %d.\n", key);
+        return EXIT_FAILURE;
+      }
+    }
+    if(SUCCESS == map_insert(&mapped, &k1, &v1)) return EXIT_FAILURE;
+    fprintf(stdout, "%zu items read back from a mapped snapshot\n", map_count(&mapped));
+    status = map_free(&mapped);
+      check(status, "Could not free map.");
+    remove("test_map.map");
+
+    status = map_free(&map);
+      check(status, "Could not free map.");
+
+    /* the copy and free hooks are applied to every key and value */
+    if(SUCCESS != test_hooks())
+    {
+      fprintf(stderr, "Map copy and free hooks miscounted.\n");
+      return EXIT_FAILURE;
+    }
+    fprintf(stdout, "map copy and free hooks applied\n");
+
+    /* an allocation failure while growing leaves the map consistent */
+    if(SUCCESS != test_grow_failure())
+    {
+      fprintf(stderr, "Map inconsistent after a failed growth.\n");
+      return EXIT_FAILURE;
+    }
+    fprintf(stdout, "map consistent after a failed growth\n");
+
     return EXIT_SUCCESS;
 
   } // main
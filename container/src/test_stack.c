@@ -6,6 +6,22 @@
   #include <stdlib.h>
   #include <stdio.h>
 
+  /* a copy hook that stores the negation of its source, and counts calls */
+  static size_t copies = 0;
+  static void copy_negated(object_t *target, const object_t *source)
+  {
+    *target = -*source;
+    ++copies;
+  }
+
+  /* a free hook that counts the objects destroyed */
+  static size_t frees = 0;
+  static void free_counted(object_t *object)
+  {
+    (void)object;
+    ++frees;
+  }
+
   /*
    * main test driver
    */
@@ -35,6 +51,85 @@
     status = stack_print(&stack, stdout);
       check(status, "Could not insert print stack.");
 
+    /* a million elements are served from slabs rather than per-cell mallocs */
+    for(object_t k=0; k<1000000; ++k)
+    {
+      status = stack_insert_front(&stack, &k);
+        check(status, "Could not insert item into stack.");
+    }
+    for(object_t k=0; k<500000; ++k)
+    {
+      status = stack_remove_front(&stack);
+        check(status, "Could not remove item from front of stack.");
+    }
+    fprintf(stdout, "%zu cells live in %zu slabs\n",
+            stack.pool.live, stack.pool.slab_count);
+
+    status = stack_clear(&stack);
+      check(status, "Could not clear stack.");
+    status = stack_insert_front(&stack, &x1);
+      check(status, "Could not insert item into stack.");
+    status = stack_print(&stack, stdout);
+      check(status, "Could not insert print stack.");
+
+    status = stack_free(&stack);
+      check(status, "Could not free stack.");
+
+    /* an unrolled stack has the same front semantics across chunk boundaries */
+    stack_t unrolled;
+    status = stack_make_unrolled(&unrolled);
+      check(status, "Could not create stack.");
+    for(object_t k=0; k<1000; ++k)
+    {
+      status = stack_insert_front(&unrolled, &k);
+        check(status, "Could not insert item into stack.");
+    }
+    for(object_t k=999; k>=3; --k)
+    {
+      if(k != *stack_front(&unrolled)) return EXIT_FAILURE;
+      status = stack_remove_front(&unrolled);
+        check(status, "Could not remove item from front of stack.");
+    }
+    status = stack_print(&unrolled, stdout);
+      check(status, "Could not insert print stack.");
+
+    status = stack_free(&unrolled);
+      check(status, "Could not free stack.");
+
+    /* installed copy and free hooks construct each object in its inline
+     *   cell, and destroy it once removed or cleared, on either layout */
+    stack_t hooked;
+    status = stack_make(&hooked);
+      check(status, "Could not create stack.");
+    status = stack_make_unrolled(&unrolled);
+      check(status, "Could not create stack.");
+    hooked.methods.copy   = &copy_negated;
+    unrolled.methods.copy = &copy_negated;
+    hooked.methods.free   = &free_counted;
+    unrolled.methods.free = &free_counted;
+    for(object_t k=1; k<=100; ++k)
+    {
+      status = stack_insert_front(&hooked, &k);
+        check(status, "Could not insert item into stack.");
+      status = stack_insert_front(&unrolled, &k);
+        check(status, "Could not insert item into stack.");
+      if(-k != *stack_front(&hooked) || -k != *stack_front(&unrolled)) return EXIT_FAILURE;
+    }
+    if(200 != copies) return EXIT_FAILURE;
+    for(object_t k=0; k<10; ++k)
+    {
+      status = stack_remove_front(&hooked);
+        check(status, "Could not remove item from front of stack.");
+      status = stack_remove_front(&unrolled);
+        check(status, "Could not remove item from front of stack.");
+    }
+    if(20 != frees) return EXIT_FAILURE;
+    status = stack_free(&hooked);
+      check(status, "Could not free stack.");
+    status = stack_free(&unrolled);
+      check(status, "Could not free stack.");
+    if(200 != frees) return EXIT_FAILURE;
+
     return EXIT_SUCCESS;
 
   } // main
@@ -0,0 +1,345 @@
+// concurrent-random-set.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "prng.h"
+  #include "random-set.h"
+  #include <algorithm>
+  #include <atomic>
+  #include <cstdint>
+  #include <functional>
+  #include <memory>
+  #include <mutex>
+  #include <random>
+  #include <stdexcept>
+  #include <type_traits>
+
+  namespace demo::algo1 {
+
+    // ==========================================================================
+    // ConcurrentRandomSet
+    // ==========================================================================
+    //
+    //   a thread-safe set-like container supporting constant time insertion
+    //     and removal under a per-shard lock, and wait-free uniform random
+    //     element selection
+    //
+    // --------------------------------------------------------------------------
+    //
+    // Background:
+    //
+    //   The set is partitioned by hash into shards, each a RandomSet-style
+    //     dense array with a flat index of positions, so that writers to
+    //     different shards do not contend.  A uniformly random element is a
+    //     uniformly random position over the concatenation of the shards:
+    //     choosing a shard with probability proportional to its size, and a
+    //     position within it uniformly, selects each element with equal
+    //     probability.
+    //
+    //   Readers take no locks.  Shard sizes are atomic, and the dense arrays
+    //     are built from segments of doubling size which are only ever added,
+    //     never moved or freed while the set lives, so a reader holding a
+    //     position below a size it has loaded always reads initialized
+    //     storage, without epochs or reclamation.
+    //
+    //
+    // Implementation:
+    //
+    //   Writers lock the shard of the element, update its index and dense
+    //     array exactly as RandomSet does (removal moves the back element into
+    //     the hole), and publish the new size with release ordering.
+    //
+    //   Readers draw a shard uniformly and a position below a common bound
+    //     on the shard sizes (the largest size any shard has reached), and
+    //     accept the draw if the position is occupied, so that each element
+    //     is equally likely on every attempt at the cost of one size load.
+    //     Shards are filled evenly by the hash, so attempts are nearly always
+    //     accepted; should the set have shrunk far below the bound, a draw
+    //     falls back to choosing a shard in proportion to a snapshot of the
+    //     shard sizes.  The snapshot is retried a few times should writers
+    //     shrink the chosen shard below the drawn position, and then the
+    //     draw settles on the first occupied shard from it, so every call
+    //     finishes in a bounded number of steps whatever the writers do
+    //     (wait-free), at the cost of exact uniformity under such sustained
+    //     contention.  An element read is one that was a member at some
+    //     instant during the call (a removal in flight may briefly expose the
+    //     back element at two positions).
+    //
+    //   Each thread draws from its own generator, on a distinct stream, so
+    //     readers share no mutable state.  For reproducible draws, pass an
+    //     explicitly seeded generator to get_random or sample.
+    //
+    //   Elements must be trivially copyable, as they are stored in atomics.
+    //
+    // Performance:
+    //
+    //   insert  constant time complexity, locking one shard:       O(1)
+    //   removal constant time complexity, locking one shard:       O(1)
+    //   random selection expected time complexity, wait-free:      O(1)
+    //     while the set is near its peak size, O(S) for S shards otherwise
+    //     (and O(S) at worst, under any contention)
+    //
+    //   linear space complexity (in the peak size of each shard):  O(N)
+    //
+    //
+    template<class T, class Index = std::uint32_t, class Hash = std::hash<T>,
+             class Generator = prng::SplitMix64>
+    class ConcurrentRandomSet
+    {
+      static_assert(std::is_trivially_copyable_v<T>, "elements must be trivially copyable");
+
+      // the first segment holds 2^segment_bits positions, each next twice the last
+      static constexpr int segment_bits = 6;
+      static constexpr int segments     = 40;
+
+      struct alignas(64) shard_t
+      {
+        std::mutex                         lock;
+        FlatIndex<Index>                   index;
+        std::atomic<std::size_t>           size{0};
+        std::size_t                        capacity = 0;
+        std::atomic<std::atomic<T>*>       segment[segments] = {};
+      };
+
+     public:
+
+      // rejected draws against the bound before drawing exactly
+      static constexpr int attempts = 4;
+
+      // elements located and prefetched ahead of reading by sample
+      static constexpr std::size_t sample_block = 64;
+
+      // shards per set, by default and at most
+      static constexpr std::size_t default_shards = 16;
+      static constexpr std::size_t max_shards     = 256;
+
+      // partitions the set into a power of two shards, at least the given
+      //   count (up to max_shards)
+      explicit ConcurrentRandomSet(std::size_t shards = default_shards)
+      {
+        while((std::size_t(1) << bits_) < std::min(shards, max_shards)) ++bits_;
+        count_  = std::size_t(1) << bits_;
+        shards_ = std::make_unique<shard_t[]>(count_);
+      };
+
+      ConcurrentRandomSet(const ConcurrentRandomSet&) = delete;
+      ConcurrentRandomSet& operator=(const ConcurrentRandomSet&) = delete;
+
+      ~ConcurrentRandomSet()
+      {
+        for(std::size_t s=0; s<count_; ++s)
+        {
+          for(int k=0; k<segments; ++k) delete[] shards_[s].segment[k].load(std::memory_order_relaxed);
+        }
+      } // ~ConcurrentRandomSet
+
+      // inserts an element, returning false if it was already present
+      inline bool insert(T x)
+      {
+        const std::size_t h = mix_hash(hash_(x));
+        shard_t &shard = shard_of(h);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        const std::size_t n = shard.size.load(std::memory_order_relaxed);
+        if(nullptr != shard.index.find(h, [&](Index p) { return at(shard, p).load(std::memory_order_relaxed) == x; })) return false;
+        if(n == shard.capacity) grow(shard);
+        at(shard, n).store(x, std::memory_order_relaxed);
+        shard.index.insert(h, static_cast<Index>(n));
+        raise(n + 1);
+        shard.size.store(n + 1, std::memory_order_release);
+        return true;
+      } // insert
+
+      // removes an element, returning false if it was not present
+      inline bool remove(T x)
+      {
+        const std::size_t h = mix_hash(hash_(x));
+        shard_t &shard = shard_of(h);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto candidate = shard.index.find(h, [&](Index p) { return at(shard, p).load(std::memory_order_relaxed) == x; });
+        if(nullptr == candidate) return false;
+        const Index position = candidate->position - 1;
+        const Index last     = static_cast<Index>(shard.size.load(std::memory_order_relaxed) - 1);
+        if(position != last)
+        {
+          const T y = at(shard, last).load(std::memory_order_relaxed);
+          auto moved = shard.index.find(mix_hash(hash_(y)), [&](Index p) { return p == last; });
+          moved->position = position + 1;
+          at(shard, position).store(y, std::memory_order_release);
+        }
+        shard.index.erase(candidate);
+        shard.size.store(last, std::memory_order_release);
+        return true;
+      } // remove
+
+      // returns the number of elements in the set (a snapshot, under writers)
+      inline std::size_t size() const
+      {
+        std::size_t total = 0;
+        for(std::size_t s=0; s<count_; ++s) total += shards_[s].size.load(std::memory_order_acquire);
+        return total;
+      } // size
+
+      // returns an element from the set with uniform random probability,
+      //   without locking
+      inline T get_random()
+      {
+        return get_random(generator());
+      } // get_random
+
+      // as get_random, drawing from the caller's generator
+      template<class G>
+      inline T get_random(G &gen)
+      {
+        G local = gen;
+        const T x = locate(local).load(std::memory_order_acquire);
+        gen = local;
+        return x;
+      } // get_random
+
+      // writes k elements drawn uniformly with replacement to out, without
+      //   locking
+      template<class OutputIt>
+      inline OutputIt sample(std::size_t k, OutputIt out)
+      {
+        return sample(k, out, generator());
+      } // sample
+
+      template<class OutputIt, class G>
+      inline OutputIt sample(std::size_t k, OutputIt out, G &gen)
+      {
+        // the generator state is kept local, out of reach of aliasing stores
+        G local = gen;
+        std::atomic<T> *cells[sample_block];
+        while(k)
+        {
+          // locate a block of elements, prefetching each, before reading any,
+          //   so that the misses of a block overlap
+          const std::size_t count = std::min(k, sample_block);
+          for(std::size_t j=0; j<count; ++j)
+          {
+            cells[j] = &locate(local);
+            __builtin_prefetch(cells[j]);
+          }
+          for(std::size_t j=0; j<count; ++j) *out++ = cells[j]->load(std::memory_order_acquire);
+          k -= count;
+        }
+        gen = local;
+        return out;
+      } // sample
+
+     private:
+
+      inline shard_t& shard_of(std::size_t hash)
+      {
+        // the index consumes the low hash bits, the shard the high ones
+        return shards_[bits_ ? (static_cast<std::uint64_t>(hash) >> (64 - bits_)) : 0];
+      } // shard_of
+
+      // draws a position uniformly over [0, bound) in every shard, accepting
+      //   it if it is occupied; after a few rejections (when the set has
+      //   shrunk well below its bound) falls back to an exact draw over a
+      //   snapshot of the shard sizes, and should writers shrink the drawn
+      //   shard under every snapshot, to the first occupied shard from it
+      template<class G>
+      inline std::atomic<T>& locate(G &gen)
+      {
+        for(int attempt=0; attempt<attempts; ++attempt)
+        {
+          const std::uint64_t bound = bound_.load(std::memory_order_relaxed);
+          // one draw over shards x positions, the shard in the low bits
+          const std::uint64_t u = bounded(gen, bound << bits_);
+          shard_t &shard = shards_[u & (count_ - 1)];
+          const std::uint64_t position = u >> bits_;
+          if(position < shard.size.load(std::memory_order_acquire)) return at(shard, position);
+        }
+        std::size_t s = 0;
+        std::uint64_t position = 0;
+        for(int attempt=0; attempt<attempts; ++attempt)
+        {
+          std::size_t ends[max_shards];
+          std::size_t total = 0;
+          for(std::size_t t=0; t<count_; ++t) ends[t] = (total += shards_[t].size.load(std::memory_order_acquire));
+          if(0 == total) throw std::out_of_range("ConcurrentRandomSet::get_random");
+          const std::uint64_t u = bounded(gen, total);
+          s = 0;
+          while(u >= ends[s]) ++s;
+          position = u - (s ? ends[s - 1] : 0);
+          // redrawn if the shard has since shrunk below the position
+          if(position < shards_[s].size.load(std::memory_order_acquire)) return at(shards_[s], position);
+        }
+        // bounded, rather than retried until writers relent, at the cost of
+        //   uniformity under such contention
+        for(std::size_t k=0; k<count_; ++k, s=(s + 1) & (count_ - 1))
+        {
+          const std::size_t size = shards_[s].size.load(std::memory_order_acquire);
+          if(size) return at(shards_[s], position % size);
+        }
+        throw std::out_of_range("ConcurrentRandomSet::get_random");
+      } // locate
+
+      // raises the bound to at least size
+      inline void raise(std::size_t size)
+      {
+        std::size_t bound = bound_.load(std::memory_order_relaxed);
+        while(bound < size && !bound_.compare_exchange_weak(bound, size, std::memory_order_relaxed));
+      } // raise
+
+      // the storage of a position, across the segments of a shard
+      static inline std::atomic<T>& at(shard_t &shard, std::size_t position)
+      {
+        const std::size_t biased = position + (std::size_t(1) << segment_bits);
+        const int top = 63 - __builtin_clzll(biased);
+        return shard.segment[top - segment_bits].load(std::memory_order_acquire)[biased - (std::size_t(1) << top)];
+      } // at
+
+      // appends a segment, doubling the capacity of a shard
+      static inline void grow(shard_t &shard)
+      {
+        // segments 0..k-1 hold 2^(k+segment_bits) - 2^segment_bits positions
+        const int k = 63 - __builtin_clzll(shard.capacity + (std::size_t(1) << segment_bits)) - segment_bits;
+        if(k >= segments) throw std::length_error("ConcurrentRandomSet: shard capacity");
+        const std::size_t length = std::size_t(1) << (k + segment_bits);
+        std::atomic<T> *segment = new std::atomic<T>[length];
+        shard.segment[k].store(segment, std::memory_order_release);
+        shard.capacity += length;
+      } // grow
+
+      // the calling thread's generator, on a stream of its own
+      static inline Generator& generator()
+      {
+        static const std::uint64_t seed = static_cast<std::uint64_t>(std::random_device{}()) << 32 | std::random_device{}();
+        static std::atomic<std::uint64_t> streams{0};
+        thread_local Generator gen(seed, streams.fetch_add(1, std::memory_order_relaxed));
+        return gen;
+      } // generator
+
+      // Lemire's multiply-shift, as in RandomSet
+      template<class G>
+      static inline std::uint64_t bounded(G &gen, std::uint64_t range)
+      {
+        unsigned __int128 m = static_cast<unsigned __int128>(gen()) * range;
+        if(static_cast<std::uint64_t>(m) < range)
+        {
+          const std::uint64_t threshold = (0 - range) % range;
+          while(static_cast<std::uint64_t>(m) < threshold)
+          {
+            m = static_cast<unsigned __int128>(gen()) * range;
+          }
+        }
+        return static_cast<std::uint64_t>(m >> 64);
+      } // bounded
+
+      std::unique_ptr<shard_t[]> shards_;
+      std::size_t count_ = 1;
+      int bits_ = 0;
+      // at least the largest shard size the set has had
+      std::atomic<std::size_t> bound_{0};
+      // element hash
+      Hash hash_;
+
+    }; // ConcurrentRandomSet
+
+  } // demo::algo1
+
+// *EOF*
@@ -0,0 +1,362 @@
+// prng.h
+// Mac Radigan
+
+  #pragma once
+
+  #include <array>
+  #include <cstddef>
+  #include <cstdint>
+  #include <limits>
+
+  // ==========================================================================
+  // prng
+  // ==========================================================================
+  //
+  //   fast 64-bit pseudo-random generators, interchangeable as the generator
+  //     policy of RandomSet
+  //
+  //   each generator is a UniformRandomBitGenerator (usable with the standard
+  //     distributions and algorithms) with, in addition:
+  //
+  //     G(seed, stream)     explicit seeding:  equal seeds and streams give
+  //                           equal sequences, on any platform; generators
+  //                           with distinct stream ids (e.g. one per thread)
+  //                           produce independent sequences from one seed
+  //     fill(words, count)  writes the next count outputs, equivalent to
+  //                           count calls but faster where the generator
+  //                           allows it
+  //
+  //   generator      state  period   streams                    fill
+  //   SplitMix64      8 B    2^64    distinct gamma             vectorized
+  //   Xoshiro256ss   32 B    2^256   jumps of 2^128             serial
+  //   PCG64          32 B    2^128   distinct increment         serial
+  //   Philox4x32     32 B    2^128   disjoint counter ranges    vectorized
+  //
+  namespace demo::prng {
+
+    // an explicit seed and stream id, as taken by the seeded constructors of
+    //   the sets (distinguishing them from constructors taking elements)
+    struct seed_t
+    {
+      std::uint64_t seed;
+      std::uint64_t stream = 0;
+    }; // seed_t
+
+    // SplitMix64 finalizer
+    inline constexpr std::uint64_t mix64(std::uint64_t z)
+    {
+      z ^= z >> 30;
+      z *= 0xbf58476d1ce4e5b9ULL;
+      z ^= z >> 27;
+      z *= 0x94d049bb133111ebULL;
+      z ^= z >> 31;
+      return z;
+    } // mix64
+
+    inline constexpr std::uint64_t rotl(std::uint64_t x, int k)
+    {
+      return (x << k) | (x >> ((64 - k) & 63));
+    } // rotl
+
+    // ==========================================================================
+    // SplitMix64
+    // ==========================================================================
+    //
+    //   a Weyl sequence (the state advances by an odd gamma) passed through
+    //     the SplitMix64 finalizer.  any output is a function of the base
+    //     state and its offset alone, so fill has no loop-carried dependence.
+    //     streams use distinct gammas derived from the stream id.
+    //
+    class SplitMix64
+    {
+     public:
+
+      using result_type = std::uint64_t;
+
+      static constexpr std::uint64_t golden = 0x9e3779b97f4a7c15ULL;
+
+      static constexpr result_type min() { return 0; };
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); };
+
+      explicit SplitMix64(std::uint64_t seed = 0, std::uint64_t stream = 0)
+       : state_(seed),
+         gamma_(0 == stream ? golden : (mix64(stream * golden) | 1))
+       {};
+
+      inline result_type operator()()
+      {
+        return mix64(state_ += gamma_);
+      } // operator()
+
+      inline void fill(std::uint64_t *words, std::size_t count)
+      {
+        const std::uint64_t base = state_;
+        for(std::size_t j=0; j<count; ++j) words[j] = mix64(base + (j + 1) * gamma_);
+        state_ = base + count * gamma_;
+      } // fill
+
+     private:
+
+      std::uint64_t state_;
+      std::uint64_t gamma_;
+
+    }; // SplitMix64
+
+    // ==========================================================================
+    // Xoshiro256ss
+    // ==========================================================================
+    //
+    //   xoshiro256** (Blackman and Vigna):  a 256-bit linear engine with a
+    //     multiplicative scrambler.  the state is expanded from the seed with
+    //     SplitMix64; stream k starts k jumps of 2^128 outputs further on, so
+    //     streams never overlap.
+    //
+    //   advancing the linear engine n outputs is the polynomial x^n (modulo
+    //     the engine's characteristic polynomial) of its transition, applied
+    //     to the state in 256 steps.  the jump of stream k is x^(2^128 k),
+    //     raised from the 2^128 jump polynomial by squaring and multiplying,
+    //     so constructing stream k takes O(log k) polynomial products and a
+    //     single application, rather than k jumps.
+    //
+    class Xoshiro256ss
+    {
+     public:
+
+      using result_type = std::uint64_t;
+
+      static constexpr result_type min() { return 0; };
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); };
+
+      explicit Xoshiro256ss(std::uint64_t seed = 0, std::uint64_t stream = 0)
+      {
+        SplitMix64 expand(seed);
+        for(auto &s : s_) s = expand();
+        jump(stream);
+      };
+
+      inline result_type operator()()
+      {
+        const std::uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const std::uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+      } // operator()
+
+      inline void fill(std::uint64_t *words, std::size_t count)
+      {
+        for(std::size_t j=0; j<count; ++j) words[j] = (*this)();
+      } // fill
+
+      // a polynomial over GF(2) of degree below 256, bit j the coefficient of x^j
+      typedef std::array<std::uint64_t, 4> polynomial_t;
+
+      // x^(2^128) modulo the characteristic polynomial
+      static constexpr polynomial_t jump_polynomial = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+      // the characteristic polynomial of the engine, less its x^256 term
+      static constexpr polynomial_t characteristic = {
+        0x9d116f2bb0f0f001ULL, 0x0280002bcefd1a5eULL,
+        0x04b4edcf26259f85ULL, 0x0003c03c3f3ecb19ULL };
+
+      // a b modulo the characteristic polynomial
+      static inline polynomial_t multiply(const polynomial_t &a, const polynomial_t &b)
+      {
+        polynomial_t r = { 0, 0, 0, 0 };
+        for(int j=255; j>=0; --j)
+        {
+          // r x, reduced by the characteristic polynomial on overflow
+          const std::uint64_t carry = r[3] >> 63;
+          for(int k=3; k>0; --k) r[k] = (r[k] << 1) | (r[k-1] >> 63);
+          r[0] <<= 1;
+          if(carry) for(int k=0; k<4; ++k) r[k] ^= characteristic[k];
+          if(b[j / 64] >> (j % 64) & 1) for(int k=0; k<4; ++k) r[k] ^= a[k];
+        }
+        return r;
+      } // multiply
+
+      // advances the state by times 2^128 outputs
+      inline void jump(std::uint64_t times = 1)
+      {
+        if(0 == times) return;
+        polynomial_t power = jump_polynomial;
+        polynomial_t total = { 1, 0, 0, 0 };
+        for(; times; times >>= 1)
+        {
+          if(times & 1) total = multiply(total, power);
+          if(times > 1) power = multiply(power, power);
+        }
+        advance(total);
+      } // jump
+
+     private:
+
+      // replaces the state s by p(T) s, T being one step of the engine
+      inline void advance(const polynomial_t &polynomial)
+      {
+        std::uint64_t t[4] = { 0, 0, 0, 0 };
+        for(auto word : polynomial)
+        {
+          for(int b=0; b<64; ++b)
+          {
+            if(word & (1ULL << b)) for(int k=0; k<4; ++k) t[k] ^= s_[k];
+            (*this)();
+          }
+        }
+        for(int k=0; k<4; ++k) s_[k] = t[k];
+      } // advance
+
+      std::uint64_t s_[4];
+
+    }; // Xoshiro256ss
+
+    // ==========================================================================
+    // PCG64
+    // ==========================================================================
+    //
+    //   PCG XSL RR 128/64 (O'Neill):  a 128-bit linear congruential state with
+    //     a xor-shift and random rotation output permutation.  the stream id
+    //     selects the (odd) increment, giving 2^127 distinct sequences.
+    //
+    class PCG64
+    {
+      using uint128_t = unsigned __int128;
+
+     public:
+
+      using result_type = std::uint64_t;
+
+      static constexpr result_type min() { return 0; };
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); };
+
+      explicit PCG64(std::uint64_t seed = 0, std::uint64_t stream = 0)
+       : state_(0),
+         increment_(static_cast<uint128_t>(mix64(stream)) << 65 | static_cast<uint128_t>(stream) << 1 | 1)
+       {
+         SplitMix64 expand(seed);
+         const uint128_t initial = static_cast<uint128_t>(expand()) << 64 | expand();
+         step();
+         state_ += initial;
+         step();
+       };
+
+      inline result_type operator()()
+      {
+        step();
+        const std::uint64_t folded = static_cast<std::uint64_t>(state_ >> 64) ^ static_cast<std::uint64_t>(state_);
+        return rotl(folded, static_cast<int>(64 - (state_ >> 122)) & 63);
+      } // operator()
+
+      inline void fill(std::uint64_t *words, std::size_t count)
+      {
+        for(std::size_t j=0; j<count; ++j) words[j] = (*this)();
+      } // fill
+
+     private:
+
+      static constexpr uint128_t multiplier =
+        static_cast<uint128_t>(0x2360ed051fc65da4ULL) << 64 | 0x4385df649fccf645ULL;
+
+      inline void step()
+      {
+        state_ = state_ * multiplier + increment_;
+      } // step
+
+      uint128_t state_;
+      uint128_t increment_;
+
+    }; // PCG64
+
+    // ==========================================================================
+    // Philox4x32
+    // ==========================================================================
+    //
+    //   Philox4x32-10 (Salmon et al.):  a counter-based generator, each output
+    //     block being ten rounds of a keyed bijection of a 128-bit counter.
+    //     the seed is the key; the low 64 counter bits count blocks and the
+    //     high 64 bits hold the stream id, so streams are disjoint and any
+    //     block can be computed without its predecessors.
+    //
+    class Philox4x32
+    {
+     public:
+
+      using result_type = std::uint64_t;
+
+      static constexpr int rounds = 10;
+
+      static constexpr result_type min() { return 0; };
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); };
+
+      explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0)
+       : key_(seed), stream_(stream)
+       {};
+
+      inline result_type operator()()
+      {
+        if(2 == used_)
+        {
+          block(counter_++, buffer_);
+          used_ = 0;
+        }
+        return buffer_[used_++];
+      } // operator()
+
+      inline void fill(std::uint64_t *words, std::size_t count)
+      {
+        std::size_t j = 0;
+        while(j < count && 2 != used_) words[j++] = buffer_[used_++];
+        const std::uint64_t base = counter_;
+        const std::size_t blocks = (count - j) / 2;
+        for(std::size_t b=0; b<blocks; ++b) block(base + b, &words[j + 2 * b]);
+        counter_ = base + blocks;
+        for(j += 2 * blocks; j < count; ++j) words[j] = (*this)();
+      } // fill
+
+      // the four 32-bit output words of a counter under a key
+      static inline void encrypt(std::uint32_t c[4], std::uint32_t k0, std::uint32_t k1)
+      {
+        for(int r=0; r<rounds; ++r)
+        {
+          const std::uint64_t p0 = static_cast<std::uint64_t>(0xd2511f53U) * c[0];
+          const std::uint64_t p1 = static_cast<std::uint64_t>(0xcd9e8d57U) * c[2];
+          const std::uint32_t c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+          const std::uint32_t c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+          c[1] = static_cast<std::uint32_t>(p1);
+          c[3] = static_cast<std::uint32_t>(p0);
+          c[0] = c0;
+          c[2] = c2;
+          k0 += 0x9e3779b9U;
+          k1 += 0xbb67ae85U;
+        }
+      } // encrypt
+
+     private:
+
+      inline void block(std::uint64_t counter, std::uint64_t *out) const
+      {
+        std::uint32_t c[4] = {
+          static_cast<std::uint32_t>(counter),  static_cast<std::uint32_t>(counter >> 32),
+          static_cast<std::uint32_t>(stream_),  static_cast<std::uint32_t>(stream_ >> 32) };
+        encrypt(c, static_cast<std::uint32_t>(key_), static_cast<std::uint32_t>(key_ >> 32));
+        out[0] = static_cast<std::uint64_t>(c[1]) << 32 | c[0];
+        out[1] = static_cast<std::uint64_t>(c[3]) << 32 | c[2];
+      } // block
+
+      std::uint64_t key_;
+      std::uint64_t stream_;
+      std::uint64_t counter_ = 0;
+      std::uint64_t buffer_[2];
+      int used_ = 2;
+
+    }; // Philox4x32
+
+  } // demo::prng
+
+// *EOF*
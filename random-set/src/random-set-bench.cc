@@ -0,0 +1,315 @@
+// random-set-bench.cc
+// Mac Radigan
+
+
+  #include "concurrent-random-set.h"
+  #include "random-set.h"
+  #include "weighted-random-set.h"
+  #include <algorithm>
+  #include <chrono>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <cstring>
+  #include <functional>
+  #include <limits>
+  #include <iostream>
+  #include <random>
+  #include <string>
+  #include <thread>
+  #include <unordered_map>
+  #include <vector>
+
+  // ==========================================================================
+  // reference::RandomSet
+  // ==========================================================================
+  //
+  //   the node-based implementation RandomSet replaced:  an unordered_map from
+  //     each element to a reference into a vector of cells, kept here as the
+  //     baseline for comparison
+  //
+  //   NB:  two defects of the original are patched so that it survives the
+  //        benchmark:  the cell vector is reserved up front (growth would
+  //        invalidate every reference held by the map), and the moved
+  //        element is re-mapped with insert_or_assign (emplace left it
+  //        pointing at the popped cell)
+  //
+  namespace reference {
+
+    template<class T>
+    class RandomSet
+    {
+
+     typedef struct cell_s
+     {
+       T cr;
+       cell_s(T &x) : cr(x) {};
+       inline void swap(struct cell_s &c) { std::swap(cr, c.cr); };
+     } cell_t;
+
+     public:
+
+      explicit RandomSet(std::size_t capacity)
+       : pdf_(0, std::numeric_limits<T>::max())
+       {
+         pick_.reserve(capacity);
+       };
+
+      inline void insert(T x)
+      {
+        if(map_.find(x) == map_.end())
+        {
+          pick_.push_back(cell_t(x));
+          map_.insert_or_assign(x, std::ref(pick_.back()));
+        }
+      } // insert
+
+      inline void remove(T x)
+      {
+        auto &top       = pick_.back();
+        auto &candidate = map_.at((x));
+        candidate.get().swap(top);
+        map_.insert_or_assign(candidate.get().cr, std::ref(candidate.get()));
+        map_.erase(x);
+        pick_.pop_back();
+      } // remove
+
+      inline std::size_t size() const
+      {
+        return map_.size();
+      } // size
+
+      inline T& get_random()
+      {
+        return pick_[pdf_(gen_) % pick_.size()].cr;
+      } // get_random
+
+     private:
+
+      std::unordered_map<T, std::reference_wrapper<cell_t> > map_;
+      std::vector<cell_t> pick_;
+      std::mt19937 gen_{std::random_device{}()};
+      std::uniform_int_distribution<T> pdf_;
+
+    }; // RandomSet
+
+  } // reference
+
+  typedef int64_t element_t;
+
+  volatile element_t sink;
+
+  static inline double now()
+  {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  } // now
+
+  static inline void report(const char *name, const char *operation, std::size_t size, std::size_t ops, double seconds)
+  {
+    std::cout << name << "," << operation << "," << size << ",ops_per_sec," << static_cast<std::uint64_t>(ops / seconds) << std::endl;
+  } // report
+
+  // inserts size distinct keys in scattered order, draws size random
+  //   elements, then removes half of the keys in shuffled order
+  template<class Set>
+  static void bench(const char *name, Set &set, std::size_t size)
+  {
+    std::vector<element_t> keys(size);
+    for(std::size_t k=0; k<size; ++k) keys[k] = static_cast<element_t>(demo::algo1::mix_hash(k) >> 1);
+
+    double start = now();
+    for(std::size_t k=0; k<size; ++k) set.insert(keys[k]);
+    report(name, "insert", size, size, now() - start);
+
+    element_t accumulator = 0;
+    start = now();
+    for(std::size_t k=0; k<size; ++k) accumulator += set.get_random();
+    report(name, "get_random", size, size, now() - start);
+    sink = accumulator;
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64{size});
+    const std::size_t removals = size / 2;
+    start = now();
+    for(std::size_t k=0; k<removals; ++k) set.remove(keys[k]);
+    report(name, "remove", size, removals, now() - start);
+  } // bench
+
+  // loads size keys (with one duplicate in eight) element by element, by
+  //   insert_range, and by the range constructor, then erases half of them
+  //   by predicate
+  static void bench_bulk(std::size_t size)
+  {
+    std::vector<element_t> keys(size);
+    for(std::size_t k=0; k<size; ++k) keys[k] = static_cast<element_t>(demo::algo1::mix_hash(k % (size - size / 8)) >> 1);
+    {
+      demo::algo1::RandomSet<element_t> set;
+      const double start = now();
+      for(auto x : keys) set.insert(x);
+      report("flat", "insert_each", size, size, now() - start);
+    }
+    {
+      demo::algo1::RandomSet<element_t> set;
+      const double start = now();
+      set.insert_range(keys.begin(), keys.end());
+      report("flat", "insert_range", size, size, now() - start);
+    }
+    {
+      double start = now();
+      demo::algo1::RandomSet<element_t> set(keys.begin(), keys.end());
+      report("flat", "range_construct", size, size, now() - start);
+      start = now();
+      const std::size_t erased = set.erase_if([](element_t x) { return x & 1; });
+      report("flat", "erase_if", size, size, now() - start);
+      sink = static_cast<element_t>(erased);
+    }
+  } // bench_bulk
+
+  // draws size elements one at a time with get_random, then in bulk with
+  //   sample and sample_unique, consumed in windows as a caller would
+  template<class Set>
+  static void bench_sample(const char *name, Set &set, std::size_t size)
+  {
+    const std::size_t window = 4096;
+    std::vector<element_t> out(window);
+    element_t accumulator = 0;
+
+    double start = now();
+    for(std::size_t k=0; k<size; ++k) accumulator += set.get_random();
+    report(name, "get_random", size, size, now() - start);
+
+    start = now();
+    for(std::size_t base=0; base<size; base+=window)
+    {
+      set.sample(window, out.begin());
+      for(auto x : out) accumulator += x;
+    }
+    report(name, "sample", size, size, now() - start);
+
+    start = now();
+    for(std::size_t base=0; base<size; base+=window)
+    {
+      set.sample_unique(window, out.begin());
+      for(auto x : out) accumulator += x;
+    }
+    report(name, "sample_unique", size, size, now() - start);
+    sink = accumulator;
+  } // bench_sample
+
+  // sampling throughput of each generator policy on an explicitly seeded set
+  template<class Generator>
+  static void bench_generator(const char *name, std::size_t size)
+  {
+    demo::algo1::RandomSet<element_t, std::uint32_t, std::hash<element_t>, Generator> set(demo::prng::seed_t{size});
+    for(std::size_t k=0; k<size; ++k) set.insert(static_cast<element_t>(k));
+    bench_sample(name, set, size);
+  } // bench_generator
+
+  // weighted insertion, weight update, selection, and removal, with weights
+  //   spanning several binary orders of magnitude
+  static void bench_weighted(std::size_t size)
+  {
+    demo::algo1::WeightedRandomSet<element_t, double> set(demo::prng::seed_t{size});
+    auto weight = [](std::size_t k) { return 1.0 + static_cast<double>(demo::algo1::mix_hash(k) % 1000); };
+
+    double start = now();
+    for(std::size_t k=0; k<size; ++k) set.insert(static_cast<element_t>(k), weight(k));
+    report("weighted", "insert", size, size, now() - start);
+
+    start = now();
+    for(std::size_t k=0; k<size; ++k) set.update(static_cast<element_t>(k), weight(k + size));
+    report("weighted", "update", size, size, now() - start);
+
+    element_t accumulator = 0;
+    start = now();
+    for(std::size_t k=0; k<size; ++k) accumulator += set.get_random();
+    report("weighted", "get_random", size, size, now() - start);
+
+    const std::size_t window = 4096;
+    std::vector<element_t> out(window);
+    start = now();
+    for(std::size_t base=0; base<size; base+=window)
+    {
+      set.sample(window, out.begin());
+      for(auto x : out) accumulator += x;
+    }
+    report("weighted", "sample", size, size, now() - start);
+    sink = accumulator;
+
+    start = now();
+    for(std::size_t k=0; k<size; k+=2) set.remove(static_cast<element_t>(k));
+    report("weighted", "remove", size, size / 2, now() - start);
+  } // bench_weighted
+
+  // lock-free sampling throughput of a concurrent set, by reader thread
+  //   count, with one writer churning the set throughout
+  static void bench_concurrent(std::size_t size)
+  {
+    demo::algo1::ConcurrentRandomSet<element_t> set;
+    for(std::size_t k=0; k<size; ++k) set.insert(static_cast<element_t>(k));
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned threads=1; threads<=cores; threads*=2)
+    {
+      std::atomic<bool> done{false};
+      std::thread writer([&] {
+        for(element_t x=size; !done.load(std::memory_order_relaxed); ++x)
+        {
+          set.insert(x);
+          set.remove(x);
+        }
+      });
+      const std::size_t draws = 4000000;
+      std::vector<std::thread> readers;
+      const double start = now();
+      for(unsigned t=0; t<threads; ++t)
+      {
+        readers.emplace_back([&] {
+          element_t accumulator = 0;
+          for(std::size_t k=0; k<draws; ++k) accumulator += set.get_random();
+          sink = accumulator;
+        });
+      }
+      for(auto &r : readers) r.join();
+      const double seconds = now() - start;
+      done = true;
+      writer.join();
+      const std::string name = "concurrent_" + std::to_string(threads);
+      report(name.c_str(), "get_random", size, threads * draws, seconds);
+    }
+  } // bench_concurrent
+
+  //
+  // main benchmark driver
+  //
+  int main(int argc, char *argv[])
+  {
+    // largest set size, e.g. -n 100000000
+    std::size_t limit = 10000000;
+    for(int k=1; k<argc-1; ++k) if(0 == std::strcmp(argv[k], "-n")) limit = std::strtoull(argv[k+1], nullptr, 10);
+
+    std::cout << "implementation,operation,size,metric,value" << std::endl;
+    for(std::size_t size=1000000; size<=limit; size*=10)
+    {
+      {
+        reference::RandomSet<element_t> set(size);
+        bench("unordered_map", set, size);
+      }
+      {
+        demo::algo1::RandomSet<element_t> set;
+        bench("flat", set, size);
+        bench_sample("flat", set, size);
+      }
+      bench_bulk(size);
+    }
+
+    bench_generator<demo::prng::SplitMix64>("splitmix64", 1000000);
+    bench_generator<demo::prng::Xoshiro256ss>("xoshiro256ss", 1000000);
+    bench_generator<demo::prng::PCG64>("pcg64", 1000000);
+    bench_generator<demo::prng::Philox4x32>("philox4x32", 1000000);
+
+    bench_weighted(1000000);
+    bench_concurrent(1000000);
+
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
@@ -0,0 +1,451 @@
+// random-set-test.cc
+// Mac Radigan
+
+
+  #include "concurrent-random-set.h"
+  #include "random-set.h"
+  #include <algorithm>
+  #include <assert.h>
+  #include <atomic>
+  #include <cmath>
+  #include <cstdint>
+  #include <cstdio>
+  #include <cstdlib>
+  #include <iostream>
+  #include <set>
+  #include <new>
+  #include <sstream>
+  #include <stdexcept>
+  #include <string>
+  #include <string_view>
+  #include <thread>
+  #include <type_traits>
+  #include <vector>
+
+  typedef int64_t element_t;
+
+  // heap allocations made by the process, counted through operator new
+  static std::atomic<int64_t> allocations{0};
+
+  void *operator new(std::size_t size)
+  {
+    ++allocations;
+    if(void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+  } // operator new
+
+  // kept out of line, so that the compiler sees operator new paired with
+  //   operator delete, rather than with the free it is inlined to
+  //   (-Wmismatched-new-delete)
+  __attribute__((noinline)) void operator delete(void *p) noexcept
+  {
+    std::free(p);
+  } // operator delete
+
+  __attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept
+  {
+    std::free(p);
+  } // operator delete
+
+  // upper critical value of the chi-square distribution with df degrees of
+  //   freedom at significance 0.001 (Wilson-Hilferty approximation)
+  static double chi_square_critical(double df)
+  {
+    const double z = 3.0902;
+    const double v = 2.0 / (9.0 * df);
+    return df * std::pow(1.0 - v + z * std::sqrt(v), 3.0);
+  } // chi_square_critical
+
+  // chi-square statistic of counts against a uniform expectation
+  static double chi_square(const std::vector<int64_t> &counts)
+  {
+    int64_t total = 0;
+    for(auto c : counts) total += c;
+    const double expected = static_cast<double>(total) / counts.size();
+    double chi = 0;
+    for(auto c : counts) chi += (c - expected) * (c - expected) / expected;
+    return chi;
+  } // chi_square
+
+  // a deliberately poor hash, so that most elements collide in the index
+  struct CollidingHash
+  {
+    inline std::size_t operator()(element_t x) const { return static_cast<std::size_t>(x & 7); };
+  }; // CollidingHash
+
+  //
+  // RandomSet behaves as a reference model (a std::set of the members, and a
+  //   vector of them to pick removals from) under a random mix of every
+  //   operation, including those on an empty set
+  //
+  template<class Set>
+  static void fuzz(const char *name, std::uint64_t seed, int steps, element_t range)
+  {
+    Set rset(demo::prng::seed_t{seed});
+    std::set<element_t> model;
+    std::vector<element_t> members;
+    demo::prng::SplitMix64 gen(seed, 1);
+    auto pick = [&](std::uint64_t n) { return static_cast<std::size_t>(gen() % n); };
+    auto forget = [&](element_t x) {
+      model.erase(x);
+      for(auto &m : members) if(m == x) { m = members.back(); members.pop_back(); break; }
+    };
+    auto verify = [&] {
+      assert(rset.size() == model.size());
+      assert(rset.empty() == model.empty());
+      std::vector<element_t> xs(rset.begin(), rset.end());
+      std::sort(xs.begin(), xs.end());
+      assert(std::equal(xs.begin(), xs.end(), model.begin(), model.end()));
+      for(auto x : model) assert(rset.contains(x));
+    };
+
+    for(int step=0; step<steps; ++step)
+    {
+      const element_t x = static_cast<element_t>(pick(range));
+      switch(pick(20))
+      {
+        case 0: case 1: case 2: case 3: case 4: case 5:
+        {
+          const bool inserted = model.insert(x).second;
+          if(inserted) members.push_back(x);
+          assert(rset.insert(x) == inserted);
+          break;
+        }
+        case 6: case 7: case 8: case 9:
+        {
+          if(members.empty()) break;
+          const element_t y = members[pick(members.size())];
+          rset.remove(y);
+          forget(y);
+          break;
+        }
+        case 10:
+        {
+          bool thrown = false;
+          if(!model.count(x))
+          {
+            try { rset.remove(x); } catch(const std::out_of_range&) { thrown = true; }
+            assert(thrown);
+          }
+          break;
+        }
+        case 11: case 12:
+        {
+          bool thrown = false;
+          try { assert(model.count(rset.get_random())); } catch(const std::out_of_range&) { thrown = true; }
+          assert(thrown == model.empty());
+          break;
+        }
+        case 13:
+        {
+          std::vector<element_t> xs;
+          bool thrown = false;
+          try { rset.sample(pick(50) + 1, std::back_inserter(xs)); } catch(const std::out_of_range&) { thrown = true; }
+          assert(thrown == model.empty());
+          for(auto y : xs) assert(model.count(y));
+          break;
+        }
+        case 14:
+        {
+          std::vector<element_t> xs;
+          const std::size_t k = pick(model.size() + 1);
+          rset.sample_unique(k, std::back_inserter(xs));
+          assert(xs.size() == k);
+          assert(std::set<element_t>(xs.begin(), xs.end()).size() == k);
+          for(auto y : xs) assert(model.count(y));
+          break;
+        }
+        case 15: case 16:
+        {
+          std::vector<element_t> xs(pick(64));
+          for(auto &y : xs) y = static_cast<element_t>(pick(range));
+          rset.insert_range(xs.begin(), xs.end());
+          for(auto y : xs) if(model.insert(y).second) members.push_back(y);
+          break;
+        }
+        case 17:
+        {
+          const element_t m = static_cast<element_t>(pick(16) + 2), r = static_cast<element_t>(pick(m));
+          auto pred = [=](element_t y) { return y % m == r; };
+          std::size_t expected = 0;
+          for(auto y : std::vector<element_t>(model.begin(), model.end())) if(pred(y)) { forget(y); ++expected; }
+          assert(rset.erase_if(pred) == expected);
+          break;
+        }
+        case 18:
+        {
+          if(0 == pick(20)) { rset.clear(); model.clear(); members.clear(); }
+          break;
+        }
+        case 19:
+        {
+          std::ostringstream os;
+          os << rset;
+          const std::string s = os.str();
+          assert(s.front() == '{' && s.substr(s.size() - 2) == "}\n");
+          assert(static_cast<std::size_t>(std::count(s.begin(), s.end(), ',')) == (model.empty() ? 0 : model.size() - 1));
+          break;
+        }
+      }
+      if(0 == step % 1000) verify();
+    }
+    verify();
+    std::cout << "test fuzz " << name << " seed " << seed << " passed" << std::endl;
+  } // fuzz
+
+  // an element type counting its copies
+  struct Tracked
+  {
+    static inline int64_t copies = 0;
+    std::string key;
+    explicit Tracked(std::string k) : key(std::move(k)) {};
+    Tracked(const Tracked &o) : key(o.key) { ++copies; };
+    Tracked(Tracked&&) = default;
+    Tracked& operator=(const Tracked &o) { key = o.key; ++copies; return *this; };
+    Tracked& operator=(Tracked&&) = default;
+    bool operator==(const Tracked &o) const { return key == o.key; };
+  }; // Tracked
+
+  struct TrackedHash
+  {
+    inline std::size_t operator()(const Tracked &x) const { return std::hash<std::string>{}(x.key); };
+  }; // TrackedHash
+
+  //
+  // elements are moved, never copied, in and out of the set; std::string
+  //   sets are searched by std::string_view without temporaries; and short
+  //   strings are inserted into a reserved set without allocating
+  //
+  static void test_move()
+  {
+    demo::algo1::RandomSet<Tracked, std::uint32_t, TrackedHash> tset(demo::prng::seed_t{3});
+    for(int k=0; k<1000; ++k) assert(tset.insert(Tracked("key-" + std::to_string(k))));
+    for(int k=0; k<1000; ++k) assert(!tset.emplace("key-" + std::to_string(k)));
+    for(int k=1000; k<2000; ++k) assert(tset.emplace("key-" + std::to_string(k)));
+    for(int k=0; k<2000; k+=3) tset.remove(Tracked("key-" + std::to_string(k)));
+    assert(tset.size() == 2000 - 667);
+    assert(Tracked::copies == 0);
+
+    using StringSet = demo::algo1::RandomSet<std::string, std::uint32_t, demo::algo1::StringHash>;
+    StringSet sset(demo::prng::seed_t{3});
+    sset.reserve(4096);
+    const int64_t before = allocations;
+    for(int k=0; k<4096; ++k)
+    {
+      char key[16];
+      std::snprintf(key, sizeof(key), "s%06d", k);
+      assert(sset.insert(std::string(key)));
+    }
+    assert(allocations == before);
+    assert(sset.contains(std::string_view("s000042")));
+    assert(!sset.contains("s999999"));
+    sset.remove(std::string_view("s000042"));
+    sset.remove("s000043");
+    assert(!sset.contains("s000042") && !sset.contains("s000043"));
+    assert(allocations == before);
+    assert(sset.size() == 4094);
+    std::cout << "test move passed" << std::endl;
+  } // test_move
+
+  //
+  // RandomSet batch sampling is uniform, and sample_unique draws distinct
+  //   elements by either method
+  //
+  static void test_sample()
+  {
+    const element_t M = 500;
+    demo::algo1::RandomSet<element_t> rset(demo::prng::seed_t{7});
+    for(element_t x=0; x<M; ++x) rset.insert(x);
+    std::vector<element_t> xs;
+    rset.sample(M * 400, std::back_inserter(xs));
+    std::vector<int64_t> counts(M);
+    for(auto x : xs) ++counts[x];
+    const double chi = chi_square(counts);
+    assert(chi < chi_square_critical(M - 1));
+    for(std::size_t k : { std::size_t(10), std::size_t(400), std::size_t(M) })
+    {
+      xs.clear();
+      rset.sample_unique(k, std::back_inserter(xs));
+      assert(std::set<element_t>(xs.begin(), xs.end()).size() == k);
+    }
+    std::cout << "test sample passed (chi-square " << chi << ")" << std::endl;
+  } // test_sample
+
+  //
+  // bulk construction deduplicates, erase_if compacts, and the rebuilt index
+  //   stays consistent with later single-element operations
+  //
+  static void test_bulk()
+  {
+    std::vector<element_t> xs;
+    demo::prng::SplitMix64 gen(5);
+    for(int k=0; k<100000; ++k) xs.push_back(static_cast<element_t>(gen() % 30000));
+    std::set<element_t> reference(xs.begin(), xs.end());
+    demo::algo1::RandomSet<element_t> rset(xs.begin(), xs.end(), demo::prng::seed_t{5});
+    assert(rset.size() == reference.size());
+    rset.insert_range(xs.begin(), xs.begin() + 1000);
+    assert(rset.size() == reference.size());
+
+    auto odd = [](element_t x) { return x & 1; };
+    std::size_t expected = 0;
+    for(auto it=reference.begin(); it!=reference.end(); ) if(odd(*it)) { it = reference.erase(it); ++expected; } else ++it;
+    assert(rset.erase_if(odd) == expected);
+    assert(rset.size() == reference.size());
+    for(element_t x=0; x<30000; x+=2) if(reference.count(x)) rset.remove(x);
+    assert(rset.size() == 0);
+
+    demo::algo1::RandomSet<element_t> small = { 3, 1, 4, 1, 5, 9, 2, 6 };
+    assert(small.size() == 7);
+
+    // braces list elements, even of the seed type; seeds are named
+    typedef demo::algo1::RandomSet<std::uint64_t> WordSet;
+    static_assert(!std::is_constructible_v<WordSet, std::uint64_t>, "seeds are passed as seed_t");
+    WordSet one{42}, two{42, 7}, seeded(demo::prng::seed_t{42}), again(demo::prng::seed_t{42});
+    assert(one.size() == 1 && one.contains(42));
+    assert(two.size() == 2 && two.contains(42) && two.contains(7));
+    assert(seeded.size() == 0);
+    for(std::uint64_t x=0; x<100; ++x) { seeded.insert(x); again.insert(x); }
+    for(int k=0; k<100; ++k) assert(seeded.get_random() == again.get_random());
+    std::cout << "test bulk passed" << std::endl;
+  } // test_bulk
+
+  //
+  // ConcurrentRandomSet agrees with std::set over random single-threaded
+  //   insertions and removals
+  //
+  static void test_concurrent_membership()
+  {
+    demo::algo1::ConcurrentRandomSet<element_t> cset(8);
+    std::set<element_t> reference;
+    demo::prng::SplitMix64 gen(11);
+    for(int k=0; k<200000; ++k)
+    {
+      const element_t x = gen() % 5000;
+      if(gen() & 1) assert(cset.insert(x) == reference.insert(x).second);
+      else          assert(cset.remove(x) == (reference.erase(x) == 1));
+    }
+    assert(cset.size() == reference.size());
+    for(int k=0; k<10000; ++k) assert(reference.count(cset.get_random()));
+    std::cout << "test concurrent membership passed" << std::endl;
+  } // test_concurrent_membership
+
+  //
+  // ConcurrentRandomSet draws stay uniform over a stable population while
+  //   writer threads churn other elements in and out of every shard
+  //
+  static void test_concurrent_uniform()
+  {
+    const element_t M       = 256;     // stable elements
+    const int       writers = 2;
+    const int       readers = 2;
+    const int64_t   draws   = 1000000; // per reader
+
+    demo::algo1::ConcurrentRandomSet<element_t> cset(16);
+    for(element_t x=0; x<M; ++x) cset.insert(x);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for(int w=0; w<writers; ++w)
+    {
+      threads.emplace_back([&, w] {
+        demo::prng::SplitMix64 gen(100 + w);
+        std::vector<element_t> churn;
+        while(!done.load(std::memory_order_relaxed))
+        {
+          const element_t x = M + w * 100000 + static_cast<element_t>(gen() % 100000);
+          if(churn.size() < 512 && cset.insert(x)) churn.push_back(x);
+          if(churn.size() >= 256 && (gen() & 1))
+          {
+            const std::size_t k = gen() % churn.size();
+            assert(cset.remove(churn[k]));
+            churn[k] = churn.back();
+            churn.pop_back();
+          }
+        }
+        for(auto x : churn) assert(cset.remove(x));
+      });
+    }
+
+    std::vector<std::vector<int64_t>> counts(readers, std::vector<int64_t>(M));
+    std::vector<std::thread> samplers;
+    for(int r=0; r<readers; ++r)
+    {
+      samplers.emplace_back([&, r] {
+        demo::prng::Xoshiro256ss gen(200, r);
+        int64_t taken = 0;
+        while(taken < draws)
+        {
+          const element_t x = cset.get_random(gen);
+          if(x < M) { ++counts[r][x]; ++taken; }
+        }
+      });
+    }
+    for(auto &t : samplers) t.join();
+    done = true;
+    for(auto &t : threads) t.join();
+
+    std::vector<int64_t> total(M);
+    for(auto &c : counts) for(element_t x=0; x<M; ++x) total[x] += c[x];
+    const double chi = chi_square(total);
+    assert(chi < chi_square_critical(M - 1));
+    assert(cset.size() == static_cast<std::size_t>(M));
+    std::cout << "test concurrent uniform passed (chi-square " << chi
+              << ", critical " << chi_square_critical(M - 1) << ")" << std::endl;
+  } // test_concurrent_uniform
+
+  // stream k of Xoshiro256ss starts k jumps of 2^128 on, however large k
+  static void test_streams()
+  {
+    typedef demo::prng::Xoshiro256ss xoshiro_t;
+    // the characteristic polynomial reproduces the published jump:  x
+    //   squared 128 times is x^(2^128)
+    xoshiro_t::polynomial_t x = { 2, 0, 0, 0 };
+    for(int k=0; k<128; ++k) x = xoshiro_t::multiply(x, x);
+    assert(x == xoshiro_t::jump_polynomial);
+
+    // small streams agree with jumping one at a time
+    for(std::uint64_t stream=0; stream<5; ++stream)
+    {
+      xoshiro_t a(300, stream), b(300);
+      for(std::uint64_t k=0; k<stream; ++k) b.jump();
+      for(int k=0; k<100; ++k) assert(a() == b());
+    }
+
+    // large streams take O(log k) products, and compose
+    const std::uint64_t large = (std::uint64_t(1) << 62) + 12345;
+    xoshiro_t a(300, large), b(300, large - 1), c(300);
+    b.jump();
+    c.jump(large / 2);
+    c.jump(large - large / 2);
+    for(int k=0; k<100; ++k)
+    {
+      const auto x = a();
+      assert(x == b() && x == c());
+    }
+    demo::algo1::RandomSet<element_t, std::uint32_t, std::hash<element_t>, xoshiro_t> rset(demo::prng::seed_t{300, large});
+    for(element_t x=0; x<100; ++x) rset.insert(x);
+    assert(rset.get_random() < 100);
+    std::cout << "test streams passed" << std::endl;
+  } // test_streams
+
+  //
+  // main test driver
+  //
+  int main(int argc, char *argv[])
+  {
+    for(std::uint64_t seed=1; seed<=4; ++seed)
+    {
+      fuzz<demo::algo1::RandomSet<element_t>>("std::hash", seed, 200000, 2000);
+      fuzz<demo::algo1::RandomSet<element_t, std::uint32_t, CollidingHash>>("colliding", seed, 50000, 300);
+      fuzz<demo::algo1::RandomSet<element_t, std::uint16_t>>("uint16_t", seed, 100000, 40000);
+    }
+    test_sample();
+    test_bulk();
+    test_move();
+    test_streams();
+    test_concurrent_membership();
+    test_concurrent_uniform();
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
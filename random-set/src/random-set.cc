@@ -2,152 +2,14 @@
 // Mac Radigan
 
 
-  #include <assert.h>
+  #include "random-set.h"
+  #include "weighted-random-set.h"
+  #include <cstdint>
   #include <cstdlib>
-  #include <functional>
-  #include <iomanip>
   #include <iostream>
   #include <iterator>
-  #include <memory>
-  #include <random>
-  #include <stdexcept>
-  #include <sys/types.h>
-  #include <unordered_map>
   #include <vector>
 
-  // ==========================================================================
-  // RandomSet
-  // ==========================================================================
-  // 
-  //   a set-like container supporting amortized constant time insertion, 
-  //     removal, and uniform random element selection
-  // 
-  // --------------------------------------------------------------------------
-  //
-  // Background:
-  //
-  //   This algorithm makes use of the standard unordered map's (hash map 
-  //     implementation) direct access for insert operations, and the standard 
-  //     vector's efficient amortized time complexity random access for 
-  //     randomly choosing an element.
-  //
-  //   This leaves only the need for removal from both the map and vector in 
-  //     constant time.  This is already supported by the unordered map, but 
-  //     for the vector is only true for back insertion/removal.  By 
-  //     introducing a cell to contain the element of interest, we can then 
-  //     swap the contents to be removed with the back of the vector prior to 
-  //     removal (for a constant-time back-removal operation).  This leaves 
-  //     only the need to identify the candidate cell of the vector for 
-  //     deletion, which may be done directly by maintaining a reference in 
-  //     the map.
-  //
-  //
-  // Implementation:
-  //
-  //   On insertion of x:T, check for existence of x in map M.  If not present, 
-  //     insert a cell c containing x into the back of vector V, and add an 
-  //     entry to the map mapping the element to the newly inserted cell, 
-  //     say x->c.
-  //
-  //   On deletion of x:T, look up the containing cell c from the map, 
-  //     say c = M[x].  Swap the contents of c with the cell at the back of 
-  //     the vector.  Update the map from the newly swapped contents to the 
-  //     cell c.  Remove x from the set.  Finally, remove the last element of 
-  //     the vector.
-  //
-  // Performance:
-  //
-  //   insert  constant time complexity:                           O(1)
-  //   removal constant time complexity:                           O(1)
-  //   random selection amortized constant time complexity:        O(1)
-  //
-  //   linear space complexity:                                    O(N)
-  //
-  //
-  namespace demo::algo1 {
-    
-    template<class T>
-    class RandomSet
-    {
-     
-     // cell_t - a LISP-style container cell with a single content register
-     typedef struct cell_s
-     {
-       T cr;
-       cell_s(T &x) : cr(x) {};
-       inline void swap(struct cell_s &c) { std::swap(cr, c.cr); };
-     } cell_t;
-     
-     public:
-      
-      RandomSet()
-       : pdf_(0, std::numeric_limits<T>::max())
-       {};
-      
-      // inserts an element into the set with constant time complexity
-      inline void insert(T x)
-      {
-        // If x is not already in the map, insert a cell containing x at the 
-        //   back of the random vector.  Map x to the last cell in the vector.
-        if(map_.find(x) == map_.end())
-        {
-          pick_.push_back(cell_t(x));
-          map_.insert_or_assign(x, std::ref(pick_.back()));
-        }
-      } // insert
-      
-      // removes an element from the set with constant time complexity
-      inline void remove(T x)
-      {
-        auto &top       = pick_.back(); // last element inserted
-        auto &candidate = map_.at((x)); // the x to be removed
-        candidate.get().swap(top);      // swap x to the back of the vector
-        // update the cell reference for the map for the cell reference 
-        //   previously at the back of the vector
-        map_.emplace(candidate.get().cr, std::ref(candidate));
-        // remove x from map
-        map_.erase(x);
-        // remove x from vector (now at back of vector)
-        pick_.pop_back();
-      } // remove
-      
-      // returns the number of elements in the set
-      inline std::size_t size() const
-      {
-        return map_.size();
-      } // size
-      
-      // returns an element from the set with uniform random probability 
-      //   in constant-time
-      inline T& get_random()
-      {
-        return pick_[pdf_(gen_) % pick_.size()].cr;
-      } // get_random
-      
-      // prints the contents of the set
-      friend inline std::ostream& operator<<(std::ostream &os, const RandomSet<T> &o)
-      {
-        os << "{";
-        for(auto it=o.pick_.begin(); it!=o.pick_.end()-1; ++it) os << it->cr << ",";
-        os << o.pick_.back().cr << "}" << std::endl;
-        return os;
-      } // operator<<
-      
-     private:
-      
-      // a map from an element to a cell containing the element T
-      std::unordered_map<T, std::reference_wrapper<cell_t> > map_;
-      // a vector of cells (containing element T)
-      std::vector<cell_t> pick_;
-      // randomization source
-      std::mt19937 gen_{std::random_device{}()};
-      // uniform distribution
-      std::uniform_int_distribution<T> pdf_;
-      
-    }; // RandomSet
-    
-  } // demo::algo1
-
   //
   // main test driver
   //
@@ -171,6 +33,10 @@
     // print
     std::cout << rset;
 
+    // an empty set prints as such, and has nothing to select
+    demo::algo1::RandomSet<element_t> none;
+    std::cout << none;
+
     // random selection
     if( rset.size() > 0 )
     {
@@ -182,6 +48,54 @@
       }
     }
 
+    // batch selection, with and without replacement
+    if( rset.size() > 0 )
+    {
+      std::vector<element_t> xs;
+      rset.sample(8, std::back_inserter(xs));
+      std::cout << "sample(8) =";
+      for(auto x : xs) std::cout << " " << x;
+      std::cout << std::endl;
+      xs.clear();
+      rset.sample_unique(rset.size(), std::back_inserter(xs));
+      std::cout << "sample_unique(" << rset.size() << ") =";
+      for(auto x : xs) std::cout << " " << x;
+      std::cout << std::endl;
+    }
+
+    // explicitly seeded sets on the same stream draw identically,
+    //   on distinct streams independently
+    {
+      demo::algo1::RandomSet<element_t, uint32_t, std::hash<element_t>, demo::prng::Philox4x32> a(demo::prng::seed_t{42}), b(demo::prng::seed_t{42}), c(demo::prng::seed_t{42, 1});
+      for(element_t x=0; x<100; ++x) { a.insert(x); b.insert(x); c.insert(x); }
+      std::vector<element_t> xa, xb, xc;
+      a.sample(16, std::back_inserter(xa));
+      b.sample(16, std::back_inserter(xb));
+      c.sample(16, std::back_inserter(xc));
+      std::cout << "seeded streams: same " << (xa == xb ? "equal" : "differ")
+                << ", distinct " << (xa == xc ? "equal" : "differ") << std::endl;
+    }
+
+    // weighted selection, e.g. backends by capacity
+    {
+      demo::algo1::WeightedRandomSet<element_t, double> wset(demo::prng::seed_t{42});
+      wset.insert(1, 1.0);
+      wset.insert(2, 2.0);
+      wset.insert(3, 5.0);
+      wset.insert(4, 0.5);
+      wset.update(4, 2.0);
+      wset.remove(1);
+      std::cout << wset;
+      std::vector<element_t> xs;
+      wset.sample(90000, std::back_inserter(xs));
+      int64_t counts[5] = { 0, 0, 0, 0, 0 };
+      for(auto x : xs) ++counts[x];
+      for(element_t x=2; x<=4; ++x)
+      {
+        std::cout << "weight " << wset.weight(x) << " drawn " << counts[x] << std::endl;
+      }
+    }
+
     return EXIT_SUCCESS;
   } // main
 
@@ -0,0 +1,595 @@
+// random-set.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "prng.h"
+  #include <algorithm>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <functional>
+  #include <initializer_list>
+  #include <iostream>
+  #include <iterator>
+  #include <random>
+  #include <stdexcept>
+  #include <string_view>
+  #include <type_traits>
+  #include <utility>
+  #include <vector>
+
+  namespace demo::algo1 {
+
+    // ==========================================================================
+    // FlatIndex
+    // ==========================================================================
+    //
+    //   an open-addressing (Robin Hood, linear probing) table mapping the hash
+    //     of an element to its position in an external dense array
+    //
+    //   slots hold only the position and the low 32 bits of the hash, so the
+    //     table never stores or copies elements:  equality is decided by a
+    //     caller-supplied predicate over positions, which the stored hash bits
+    //     filter so that a probe rarely touches the dense array, and growth
+    //     rehashes from the stored bits without touching it at all.
+    //     deletion shifts successors back, leaving no tombstones.
+    //
+    template<class Index = std::uint32_t>
+    class FlatIndex
+    {
+     public:
+
+      struct slot_t
+      {
+        Index         position; // position in the dense array plus one, zero if empty
+        std::uint32_t hash;     // low bits of the element hash
+      };
+
+      // maximum load factor, as a fraction of load_denominator
+      static constexpr std::size_t load_numerator   = 7;
+      static constexpr std::size_t load_denominator = 8;
+
+      FlatIndex() : slots_(8) {};
+
+      // returns the slot whose position satisfies equal, or nullptr
+      template<class Equal>
+      inline slot_t* find(std::size_t hash, Equal &&equal)
+      {
+        const std::size_t mask = slots_.size() - 1;
+        const auto h = static_cast<std::uint32_t>(hash);
+        for(std::size_t k=h&mask, distance=0; ; k=(k+1)&mask, ++distance)
+        {
+          slot_t &slot = slots_[k];
+          // an empty slot, or one closer to its home than we are to ours,
+          //   terminates the probe sequence
+          if(!slot.position || displacement(slot, k) < distance) return nullptr;
+          if(slot.hash == h && equal(slot.position - 1)) return &slot;
+        }
+      } // find
+
+      template<class Equal>
+      inline const slot_t* find(std::size_t hash, Equal &&equal) const
+      {
+        return const_cast<FlatIndex*>(this)->find(hash, std::forward<Equal>(equal));
+      } // find
+
+      // prefetches the home slot of a hash ahead of a find or insert
+      inline void prefetch(std::size_t hash) const
+      {
+        __builtin_prefetch(&slots_[hash & (slots_.size() - 1)]);
+      } // prefetch
+
+      // indexes an element known to be absent at the given position
+      inline void insert(std::size_t hash, Index position)
+      {
+        if(count_ + 1 > capacity(slots_.size())) rehash(2 * slots_.size());
+        place(slot_t{ static_cast<Index>(position + 1), static_cast<std::uint32_t>(hash) });
+      } // insert
+
+      // removes a slot returned by find
+      inline void erase(slot_t *slot)
+      {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t k = static_cast<std::size_t>(slot - slots_.data());
+        for(;;)
+        {
+          const std::size_t next = (k + 1) & mask;
+          if(!slots_[next].position || 0 == displacement(slots_[next], next)) break;
+          slots_[k] = slots_[next];
+          k = next;
+        }
+        slots_[k] = slot_t{ 0, 0 };
+        --count_;
+      } // erase
+
+      inline std::size_t size() const { return count_; };
+
+      // grows the table to index size elements without rehashing
+      inline void reserve(std::size_t size)
+      {
+        std::size_t slots = slots_.size();
+        while(capacity(slots) < size) slots <<= 1;
+        if(slots > slots_.size()) rehash(slots);
+      } // reserve
+
+      inline void clear()
+      {
+        std::fill(slots_.begin(), slots_.end(), slot_t{ 0, 0 });
+        count_ = 0;
+      } // clear
+
+     private:
+
+      static inline std::size_t capacity(std::size_t slots)
+      {
+        return slots * load_numerator / load_denominator;
+      } // capacity
+
+      // distance of an occupied slot at k from its home slot
+      inline std::size_t displacement(const slot_t &slot, std::size_t k) const
+      {
+        return (k - slot.hash) & (slots_.size() - 1);
+      } // displacement
+
+      inline void place(slot_t carry)
+      {
+        const std::size_t mask = slots_.size() - 1;
+        for(std::size_t k=carry.hash&mask, distance=0; ; k=(k+1)&mask, ++distance)
+        {
+          slot_t &slot = slots_[k];
+          if(!slot.position)
+          {
+            slot = carry;
+            ++count_;
+            return;
+          }
+          // Robin Hood:  take from the rich (near home), give to the poor
+          const std::size_t resident = displacement(slot, k);
+          if(resident < distance)
+          {
+            std::swap(slot, carry);
+            distance = resident;
+          }
+        }
+      } // place
+
+      inline void rehash(std::size_t slots)
+      {
+        std::vector<slot_t> old(slots);
+        old.swap(slots_);
+        count_ = 0;
+        for(const auto &slot : old) if(slot.position) place(slot);
+      } // rehash
+
+      std::vector<slot_t> slots_; // a power of two in size
+      std::size_t count_ = 0;
+
+    }; // FlatIndex
+
+    // detects a transparent (heterogeneous lookup) hash or equality policy
+    template<class P, class = void>
+    struct is_transparent : std::false_type {};
+
+    template<class P>
+    struct is_transparent<P, std::void_t<typename P::is_transparent>> : std::true_type {};
+
+    // a transparent string hash, so that std::string elements may be looked
+    //   up by std::string_view or string literal without a temporary string
+    struct StringHash
+    {
+      using is_transparent = void;
+      inline std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); };
+    }; // StringHash
+
+    // SplitMix64 finalizer, so that identity hashes (std::hash of integers)
+    //   spread over the low bits used for bucket selection
+    inline std::size_t mix_hash(std::size_t x)
+    {
+      std::uint64_t z = x;
+      z ^= z >> 30;
+      z *= 0xbf58476d1ce4e5b9ULL;
+      z ^= z >> 27;
+      z *= 0x94d049bb133111ebULL;
+      z ^= z >> 31;
+      return static_cast<std::size_t>(z);
+    } // mix_hash
+
+    // ==========================================================================
+    // RandomSet
+    // ==========================================================================
+    //
+    //   a set-like container supporting amortized constant time insertion,
+    //     removal, and uniform random element selection
+    //
+    // --------------------------------------------------------------------------
+    //
+    // Background:
+    //
+    //   This algorithm stores the elements contiguously in a dense vector,
+    //     whose random access makes choosing a uniformly random element a
+    //     single index operation, and locates elements through a flat
+    //     open-addressing index mapping each element to its position in the
+    //     vector.
+    //
+    //   This leaves only the need for removal from both the index and vector
+    //     in constant time.  For the vector this is only true for back
+    //     removal, so the element to be removed is first overwritten by the
+    //     element at the back of the vector (for a constant-time back-removal
+    //     operation), and the index entry of the moved element is updated to
+    //     its new position.
+    //
+    //   Since the index records positions rather than references, growing
+    //     the vector never invalidates it, and since both structures are flat
+    //     arrays there is no per-element heap allocation.
+    //
+    //
+    // Implementation:
+    //
+    //   On insertion of x:T, probe the index I for x.  If not present, append
+    //     x to the back of vector V, and index x at its position, say
+    //     x -> |V|-1.
+    //
+    //   On deletion of x:T, look up the position p of x from the index, say
+    //     p = I[x].  Move the element y at the back of the vector to position
+    //     p, and update the index to y -> p.  Remove x from the index.
+    //     Finally, remove the last element of the vector.
+    //
+    // Performance:
+    //
+    //   insert  constant time complexity:                           O(1)
+    //   removal constant time complexity:                           O(1)
+    //   random selection amortized constant time complexity:        O(1)
+    //   sampling k elements, with or without replacement:           O(k)
+    //
+    //   linear space complexity:                                    O(N)
+    //
+    //
+    //   the Generator policy (see prng.h) trades throughput for statistical
+    //     quality:  SplitMix64 and Philox4x32 generate sampling blocks with
+    //     vectorized, counter-style fills.  a set seeded explicitly, with a
+    //     distinct stream per thread, reproduces its draws exactly.
+    //
+    //   Elements are stored once, in the dense vector, and moved rather than
+    //     copied in and out of it; the index holds only hashes and positions.
+    //     With a transparent Hash (declaring is_transparent, e.g. StringHash)
+    //     and KeyEqual, membership and removal accept any key type the two
+    //     accept, such as a std::string_view for std::string elements.
+    //
+    template<class T, class Index = std::uint32_t, class Hash = std::hash<T>,
+             class Generator = prng::SplitMix64, class KeyEqual = std::equal_to<>>
+    class RandomSet
+    {
+      // heterogeneous lookup is enabled by transparent hash and equality
+      static constexpr bool transparent = is_transparent<Hash>::value && is_transparent<KeyEqual>::value;
+
+     public:
+
+      // words drawn from the generator per block by the sampling operations
+      static constexpr std::size_t sample_block = 256;
+
+      // elements hashed and prefetched ahead of probing by the bulk operations
+      static constexpr std::size_t bulk_block = 32;
+
+      // Floyd's algorithm is used for sample_unique when k is at most
+      //   size / floyd_ratio, a partial Fisher-Yates shuffle otherwise
+      static constexpr std::size_t floyd_ratio = 16;
+
+      // seeds the generator nondeterministically
+      RandomSet()
+       : gen_(static_cast<std::uint64_t>(std::random_device{}()) << 32 | std::random_device{}())
+       {};
+
+      // seeds the generator explicitly, on an independent stream per id,
+      //   e.g. RandomSet(seed_t{42}); RandomSet{42} is the set of 42
+      explicit RandomSet(prng::seed_t seed)
+       : gen_(seed.seed, seed.stream)
+       {};
+
+      // builds the set of the elements of a range, or of a list
+      template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+      RandomSet(InputIt first, InputIt last)
+       : RandomSet()
+       {
+         insert_range(first, last);
+       };
+
+      template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+      RandomSet(InputIt first, InputIt last, prng::seed_t seed)
+       : RandomSet(seed)
+       {
+         insert_range(first, last);
+       };
+
+      RandomSet(std::initializer_list<T> xs)
+       : RandomSet()
+       {
+         insert_range(xs.begin(), xs.end());
+       };
+
+      // inserts an element into the set with constant time complexity,
+      //   returning false if it was already present
+      inline bool insert(const T &x) { return place(x); };
+      inline bool insert(T &&x) { return place(std::move(x)); };
+
+      // constructs an element in place at the back of the dense vector,
+      //   keeping it if not already present
+      template<class... Args>
+      inline bool emplace(Args&&... args)
+      {
+        dense_.emplace_back(std::forward<Args>(args)...);
+        const Index last = static_cast<Index>(dense_.size() - 1);
+        const T &x = dense_.back();
+        const std::size_t h = mix_hash(hash_(x));
+        if(nullptr != index_.find(h, [&](Index p) { return equal_(dense_[p], x); }))
+        {
+          dense_.pop_back();
+          return false;
+        }
+        index_.insert(h, last);
+        return true;
+      } // emplace
+
+      // inserts the elements of a range, skipping those already present
+      template<class InputIt>
+      inline void insert_range(InputIt first, InputIt last)
+      {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr(!std::is_base_of_v<std::forward_iterator_tag, category>)
+        {
+          for(; first != last; ++first) insert(*first);
+        }
+        else
+        {
+          // size both structures for the whole range up front, so that
+          //   neither grows part way through
+          reserve(dense_.size() + static_cast<std::size_t>(std::distance(first, last)));
+          std::size_t hashes[bulk_block];
+          while(first != last)
+          {
+            // hash a block and prefetch the home slots of its elements before
+            //   probing any, so that the index misses of a block overlap;
+            //   duplicates, within the range or with the set, are rejected
+            //   by the probe
+            std::size_t count = 0;
+            for(InputIt it=first; it!=last && count<bulk_block; ++it, ++count)
+            {
+              hashes[count] = mix_hash(hash_(*it));
+              index_.prefetch(hashes[count]);
+            }
+            for(std::size_t j=0; j<count; ++j, ++first)
+            {
+              // forwarded, so that a range of move iterators is moved in
+              auto &&x = *first;
+              if(nullptr == index_.find(hashes[j], [&](Index p) { return equal_(dense_[p], x); }))
+              {
+                index_.insert(hashes[j], static_cast<Index>(dense_.size()));
+                dense_.push_back(std::forward<decltype(x)>(x));
+              }
+            }
+          }
+        }
+      } // insert_range
+
+      // removes an element from the set with constant time complexity;
+      //   throws std::out_of_range if it is absent
+      inline void remove(const T &x) { erase(x); };
+
+      template<class K, class = std::enable_if_t<transparent, K>>
+      inline void remove(const K &key) { erase(key); };
+
+      // removes every element satisfying pred, returning the number removed
+      template<class Predicate>
+      inline std::size_t erase_if(Predicate pred)
+      {
+        // compact the survivors in one pass, then index them afresh, rather
+        //   than swapping each removal in from the back
+        auto end = std::remove_if(dense_.begin(), dense_.end(), pred);
+        const std::size_t erased = static_cast<std::size_t>(dense_.end() - end);
+        if(0 == erased) return 0;
+        dense_.erase(end, dense_.end());
+        reindex();
+        return erased;
+      } // erase_if
+
+      // removes every element
+      inline void clear()
+      {
+        dense_.clear();
+        index_.clear();
+      } // clear
+
+      // sizes the dense vector and index to hold size elements without growing
+      inline void reserve(std::size_t size)
+      {
+        dense_.reserve(size);
+        index_.reserve(size);
+      } // reserve
+
+      // returns the number of elements in the set
+      inline std::size_t size() const
+      {
+        return dense_.size();
+      } // size
+
+      inline bool empty() const
+      {
+        return dense_.empty();
+      } // empty
+
+      // tests membership with constant time complexity
+      inline bool contains(const T &x) const { return nullptr != locate(x); };
+
+      template<class K, class = std::enable_if_t<transparent, K>>
+      inline bool contains(const K &key) const { return nullptr != locate(key); };
+
+      // iterates over the elements, in no particular order; iterators are
+      //   invalidated by any insertion or removal
+      inline typename std::vector<T>::const_iterator begin() const { return dense_.begin(); };
+      inline typename std::vector<T>::const_iterator end() const { return dense_.end(); };
+
+      // returns an element from the set with uniform random probability
+      //   in constant-time; throws std::out_of_range if the set is empty
+      inline T& get_random()
+      {
+        if(dense_.empty()) throw std::out_of_range("RandomSet::get_random");
+        return dense_[bounded(gen_(), dense_.size())];
+      } // get_random
+
+      // writes k elements drawn uniformly with replacement to out
+      template<class OutputIt>
+      inline OutputIt sample(std::size_t k, OutputIt out)
+      {
+        if(k && dense_.empty()) throw std::out_of_range("RandomSet::sample");
+        const std::uint64_t range = dense_.size();
+        std::uint64_t words[sample_block];
+        while(k)
+        {
+          const std::size_t count = std::min(k, sample_block);
+          gen_.fill(words, count);
+          // map words to indices first, prefetching the elements they select,
+          //   so that the misses of a block overlap
+          for(std::size_t j=0; j<count; ++j)
+          {
+            words[j] = bounded(words[j], range);
+            __builtin_prefetch(&dense_[words[j]]);
+          }
+          for(std::size_t j=0; j<count; ++j) *out++ = dense_[words[j]];
+          k -= count;
+        }
+        return out;
+      } // sample
+
+      // writes k distinct elements, drawn uniformly without replacement, to out
+      template<class OutputIt>
+      inline OutputIt sample_unique(std::size_t k, OutputIt out)
+      {
+        const std::size_t n = dense_.size();
+        if(k > n) throw std::out_of_range("RandomSet::sample_unique");
+        if(k * floyd_ratio <= n)
+        {
+          // Floyd's algorithm:  for j in [n-k, n), choose t from [0, j]; take t
+          //   if not yet chosen, else j (which cannot have been), with the
+          //   chosen positions held in a small index of their own
+          FlatIndex<std::uint64_t> chosen;
+          chosen.reserve(k);
+          for(std::size_t j=n-k; j<n; ++j)
+          {
+            std::uint64_t t = bounded(gen_(), j + 1);
+            if(nullptr != chosen.find(mix_hash(t), [&](std::uint64_t p) { return p == t; })) t = j;
+            chosen.insert(mix_hash(t), t);
+            *out++ = dense_[t];
+          }
+        }
+        else
+        {
+          // partial Fisher-Yates over a scratch copy:  swap a uniform choice
+          //   of the remaining suffix into each of the first k places
+          std::vector<T> scratch(dense_);
+          for(std::size_t j=0; j<k; ++j)
+          {
+            std::swap(scratch[j], scratch[j + bounded(gen_(), n - j)]);
+            *out++ = std::move(scratch[j]);
+          }
+        }
+        return out;
+      } // sample_unique
+
+      // prints the contents of the set
+      friend inline std::ostream& operator<<(std::ostream &os, const RandomSet &o)
+      {
+        os << "{";
+        for(auto it=o.dense_.begin(); it!=o.dense_.end(); ++it) os << (it == o.dense_.begin() ? "" : ",") << *it;
+        os << "}" << std::endl;
+        return os;
+      } // operator<<
+
+     private:
+
+      template<class K>
+      inline const typename FlatIndex<Index>::slot_t* locate(const K &key) const
+      {
+        return index_.find(mix_hash(hash_(key)), [&](Index p) { return equal_(dense_[p], key); });
+      } // locate
+
+      template<class U>
+      inline bool place(U &&x)
+      {
+        // If x is not already indexed, append x to the back of the dense
+        //   vector and index x at the last position.
+        const std::size_t h = mix_hash(hash_(x));
+        if(nullptr != index_.find(h, [&](Index p) { return equal_(dense_[p], x); })) return false;
+        index_.insert(h, static_cast<Index>(dense_.size()));
+        dense_.push_back(std::forward<U>(x));
+        return true;
+      } // place
+
+      // removes the element equal to key
+      template<class K>
+      inline void erase(const K &key)
+      {
+        auto candidate = const_cast<typename FlatIndex<Index>::slot_t*>(locate(key));
+        if(nullptr == candidate) throw std::out_of_range("RandomSet::remove");
+        const Index position = candidate->position - 1;
+        const Index last     = static_cast<Index>(dense_.size() - 1);
+        if(position != last)
+        {
+          // move the back element into the hole, and re-index it there
+          auto moved = index_.find(mix_hash(hash_(dense_[last])), [&](Index p) { return p == last; });
+          moved->position = position + 1;
+          dense_[position] = std::move(dense_[last]);
+        }
+        index_.erase(candidate);
+        dense_.pop_back();
+      } // erase
+
+      // rebuilds the index from the dense vector
+      inline void reindex()
+      {
+        index_.clear();
+        index_.reserve(dense_.size());
+        std::size_t hashes[bulk_block];
+        for(std::size_t base=0; base<dense_.size(); base+=bulk_block)
+        {
+          const std::size_t count = std::min(bulk_block, dense_.size() - base);
+          for(std::size_t j=0; j<count; ++j)
+          {
+            hashes[j] = mix_hash(hash_(dense_[base + j]));
+            index_.prefetch(hashes[j]);
+          }
+          for(std::size_t j=0; j<count; ++j) index_.insert(hashes[j], static_cast<Index>(base + j));
+        }
+      } // reindex
+
+      // Lemire's multiply-shift:  the high word of word * range is uniform over
+      //   [0, range) once low words below 2^64 mod range are rejected.  that
+      //   threshold is below range, so the division computing it is only
+      //   reached when the low word is, with probability range / 2^64.
+      inline std::uint64_t bounded(std::uint64_t word, std::uint64_t range)
+      {
+        unsigned __int128 m = static_cast<unsigned __int128>(word) * range;
+        if(static_cast<std::uint64_t>(m) < range)
+        {
+          const std::uint64_t threshold = (0 - range) % range;
+          while(static_cast<std::uint64_t>(m) < threshold)
+          {
+            m = static_cast<unsigned __int128>(gen_()) * range;
+          }
+        }
+        return static_cast<std::uint64_t>(m >> 64);
+      } // bounded
+
+      // the elements, densely packed
+      std::vector<T> dense_;
+      // a map from an element to its position in the dense vector
+      FlatIndex<Index> index_;
+      // element hash and equality
+      Hash hash_;
+      KeyEqual equal_;
+      // randomization source
+      Generator gen_;
+
+    }; // RandomSet
+
+  } // demo::algo1
+
+// *EOF*
@@ -0,0 +1,373 @@
+// weighted-random-set.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "prng.h"
+  #include "random-set.h"
+  #include <cmath>
+  #include <cstdint>
+  #include <functional>
+  #include <iostream>
+  #include <limits>
+  #include <random>
+  #include <stdexcept>
+  #include <type_traits>
+  #include <utility>
+  #include <vector>
+
+  namespace demo::algo1 {
+
+    // ==========================================================================
+    // WeightedRandomSet
+    // ==========================================================================
+    //
+    //   a set-like container of weighted elements supporting constant time
+    //     insertion, removal, and weight update, and element selection with
+    //     probability proportional to weight in expected constant time
+    //
+    // --------------------------------------------------------------------------
+    //
+    // Background:
+    //
+    //   As in RandomSet, the elements are stored densely in a vector and
+    //     located through a flat index of their positions, with removal
+    //     overwriting the element to be removed by the back element.
+    //
+    //   Weights are partitioned into classes by binary exponent, class e
+    //     holding the weights in [2^e, 2^(e+1)).  Each class keeps a bucket
+    //     of the positions of its elements, again removed by swapping with
+    //     the back, and the total of its weights.  Choosing a class with
+    //     probability proportional to its total, and then an element of the
+    //     class uniformly, accepted with probability w / 2^(e+1), selects an
+    //     element with probability proportional to its weight.  Since every
+    //     weight of the class is at least half the bound, each attempt is
+    //     accepted with probability at least one half.
+    //
+    //
+    // Implementation:
+    //
+    //   Each dense entry records its element, weight, class and position in
+    //     the class bucket, and each bucket the dense positions of its
+    //     members, so that moving an entry (within the dense vector or its
+    //     bucket) updates the one back-reference to it.  Bucket members also
+    //     carry their acceptance probability, so that a rejected attempt
+    //     does not touch the dense vector.
+    //
+    //   Only classes with members are scanned when choosing a class, so the
+    //     cost of the choice is bounded by the number of distinct weight
+    //     exponents in use rather than the number of elements.  Class totals
+    //     are maintained incrementally and recomputed exactly after as many
+    //     updates as the class has members, bounding floating point drift at
+    //     amortized constant cost.
+    //
+    //   Elements of zero weight are held but never selected.
+    //
+    // Performance:
+    //
+    //   insert, removal, and weight update constant time complexity:  O(1)
+    //   weighted random selection expected time complexity:           O(C)
+    //     for C weight classes in use (at most 64 for integral weights)
+    //
+    //   linear space complexity:                                      O(N)
+    //
+    //
+    template<class T, class W = double, class Index = std::uint32_t,
+             class Hash = std::hash<T>, class Generator = prng::SplitMix64>
+    class WeightedRandomSet
+    {
+      static_assert(std::is_arithmetic_v<W>, "weights must be arithmetic");
+
+      struct entry_t
+      {
+        T             element;
+        W             weight;
+        std::uint32_t bucket;   // weight class
+        Index         position; // position within the class bucket
+      };
+
+      struct member_t
+      {
+        double accept;   // acceptance probability, the weight over the class bound
+        Index  position; // dense position
+      };
+
+      struct bucket_t
+      {
+        std::vector<member_t> members;
+        double                total   = 0;
+        std::size_t           updates = 0; // since total was last recomputed
+        std::uint32_t         active  = 0; // position in the active list
+      };
+
+      // classes by binary exponent, with class zero reserved for zero weights
+      static constexpr int min_exponent = std::is_floating_point_v<W>
+        ? std::numeric_limits<W>::min_exponent - std::numeric_limits<W>::digits : 0;
+      static constexpr int max_exponent = std::is_floating_point_v<W>
+        ? std::numeric_limits<W>::max_exponent - 1 : std::numeric_limits<W>::digits - 1;
+      static constexpr std::uint32_t zero_class = 0;
+
+     public:
+
+      // seeds the generator nondeterministically
+      WeightedRandomSet()
+       : WeightedRandomSet(prng::seed_t{static_cast<std::uint64_t>(std::random_device{}()) << 32 | std::random_device{}()})
+       {};
+
+      // seeds the generator explicitly, on an independent stream per id
+      explicit WeightedRandomSet(prng::seed_t seed)
+       : buckets_(max_exponent - min_exponent + 2), gen_(seed.seed, seed.stream)
+       {};
+
+      // inserts an element with the given weight, if not already present
+      inline void insert(T x, W w)
+      {
+        validate(w);
+        const std::size_t h = mix_hash(hash_(x));
+        if(nullptr == index_.find(h, [&](Index p) { return dense_[p].element == x; }))
+        {
+          const Index position = static_cast<Index>(dense_.size());
+          index_.insert(h, position);
+          dense_.push_back(entry_t{ std::move(x), w, 0, 0 });
+          attach(position);
+        }
+      } // insert
+
+      // removes an element from the set
+      inline void remove(const T &x)
+      {
+        auto candidate = locate(x);
+        const Index position = candidate->position - 1;
+        const Index last     = static_cast<Index>(dense_.size() - 1);
+        detach(position);
+        if(position != last)
+        {
+          // move the back entry into the hole, and re-point its index slot
+          //   and bucket member there
+          auto moved = index_.find(mix_hash(hash_(dense_[last].element)), [&](Index p) { return p == last; });
+          moved->position = position + 1;
+          dense_[position] = std::move(dense_[last]);
+          buckets_[dense_[position].bucket].members[dense_[position].position].position = position;
+        }
+        index_.erase(candidate);
+        dense_.pop_back();
+      } // remove
+
+      // changes the weight of an element
+      inline void update(const T &x, W w)
+      {
+        validate(w);
+        const Index position = locate(x)->position - 1;
+        detach(position);
+        dense_[position].weight = w;
+        attach(position);
+      } // update
+
+      // returns the weight of an element
+      inline W weight(const T &x) const
+      {
+        return dense_[locate(x)->position - 1].weight;
+      } // weight
+
+      // returns the number of elements in the set
+      inline std::size_t size() const
+      {
+        return dense_.size();
+      } // size
+
+      // returns the sum of the weights
+      inline double total_weight() const
+      {
+        double total = 0;
+        for(auto c : active_) total += buckets_[c].total;
+        return total;
+      } // total_weight
+
+      // returns an element with probability proportional to its weight
+      inline T& get_random()
+      {
+        if(active_.empty()) throw std::out_of_range("WeightedRandomSet::get_random");
+        double u = uniform() * total_weight();
+        std::size_t k = 0;
+        for(; k + 1 < active_.size(); ++k)
+        {
+          if(u < buckets_[active_[k]].total) break;
+          u -= buckets_[active_[k]].total;
+        }
+        return draw(active_[k]);
+      } // get_random
+
+      // writes k elements drawn with replacement, proportionally to weight,
+      //   to out
+      template<class OutputIt>
+      inline OutputIt sample(std::size_t k, OutputIt out)
+      {
+        if(k && active_.empty()) throw std::out_of_range("WeightedRandomSet::sample");
+        // the cumulative class totals are formed once for the batch
+        std::vector<double> cumulative(active_.size());
+        double total = 0;
+        for(std::size_t j=0; j<active_.size(); ++j) cumulative[j] = (total += buckets_[active_[j]].total);
+        for(; k; --k)
+        {
+          const double u = uniform() * total;
+          std::size_t j = 0;
+          while(j + 1 < cumulative.size() && !(u < cumulative[j])) ++j;
+          *out++ = draw(active_[j]);
+        }
+        return out;
+      } // sample
+
+      // prints the contents of the set as element:weight pairs
+      friend inline std::ostream& operator<<(std::ostream &os, const WeightedRandomSet &o)
+      {
+        os << "{";
+        for(std::size_t k=0; k<o.dense_.size(); ++k)
+        {
+          os << (k ? "," : "") << o.dense_[k].element << ":" << o.dense_[k].weight;
+        }
+        os << "}" << std::endl;
+        return os;
+      } // operator<<
+
+     private:
+
+      static inline void validate(W w)
+      {
+        bool valid = true;
+        if constexpr(std::is_floating_point_v<W>) valid = std::isfinite(w) && w >= 0;
+        else if constexpr(std::is_signed_v<W>) valid = w >= 0;
+        if(!valid) throw std::invalid_argument("WeightedRandomSet: weight");
+      } // validate
+
+      // binary exponent of a positive weight
+      static inline int exponent(W w)
+      {
+        if constexpr(std::is_floating_point_v<W>)
+          return std::ilogb(w);
+        else
+          return 63 - __builtin_clzll(static_cast<unsigned long long>(w));
+      } // exponent
+
+      static inline std::uint32_t weight_class(W w)
+      {
+        return (w == 0) ? zero_class : static_cast<std::uint32_t>(exponent(w) - min_exponent + 1);
+      } // weight_class
+
+      inline const typename FlatIndex<Index>::slot_t* locate(const T &x) const
+      {
+        auto slot = index_.find(mix_hash(hash_(x)), [&](Index p) { return dense_[p].element == x; });
+        if(nullptr == slot) throw std::out_of_range("WeightedRandomSet: element");
+        return slot;
+      } // locate
+
+      inline typename FlatIndex<Index>::slot_t* locate(const T &x)
+      {
+        return const_cast<typename FlatIndex<Index>::slot_t*>(static_cast<const WeightedRandomSet*>(this)->locate(x));
+      } // locate
+
+      // adds the entry at a dense position to the bucket of its weight class
+      inline void attach(Index position)
+      {
+        entry_t &entry = dense_[position];
+        const std::uint32_t c = weight_class(entry.weight);
+        bucket_t &bucket = buckets_[c];
+        entry.bucket   = c;
+        entry.position = static_cast<Index>(bucket.members.size());
+        const double accept = (zero_class == c) ? 0
+          : std::ldexp(static_cast<double>(entry.weight), -(static_cast<int>(c) + min_exponent));
+        bucket.members.push_back(member_t{ accept, position });
+        if(zero_class == c) return;
+        bucket.total += static_cast<double>(entry.weight);
+        if(1 == bucket.members.size())
+        {
+          bucket.active = static_cast<std::uint32_t>(active_.size());
+          active_.push_back(c);
+        }
+        refresh(bucket);
+      } // attach
+
+      // removes the entry at a dense position from its class bucket
+      inline void detach(Index position)
+      {
+        const entry_t &entry = dense_[position];
+        bucket_t &bucket = buckets_[entry.bucket];
+        const member_t moved = bucket.members.back();
+        bucket.members[entry.position] = moved;
+        dense_[moved.position].position = entry.position;
+        bucket.members.pop_back();
+        if(zero_class == entry.bucket) return;
+        bucket.total -= static_cast<double>(entry.weight);
+        if(bucket.members.empty())
+        {
+          // retire the class from the active list, swapping with the back
+          bucket.total   = 0;
+          bucket.updates = 0;
+          const std::uint32_t back = active_.back();
+          active_[bucket.active] = back;
+          buckets_[back].active  = bucket.active;
+          active_.pop_back();
+          return;
+        }
+        refresh(bucket);
+      } // detach
+
+      // recomputes a class total once as many updates as members accumulate
+      inline void refresh(bucket_t &bucket)
+      {
+        if(++bucket.updates < bucket.members.size()) return;
+        double total = 0;
+        for(const auto &member : bucket.members) total += static_cast<double>(dense_[member.position].weight);
+        bucket.total   = total;
+        bucket.updates = 0;
+      } // refresh
+
+      // draws a member of a class by rejection against the class bound
+      inline T& draw(std::uint32_t c)
+      {
+        const bucket_t &bucket = buckets_[c];
+        for(;;)
+        {
+          const member_t &member = bucket.members[bounded(gen_(), bucket.members.size())];
+          if(uniform() < member.accept) return dense_[member.position].element;
+        }
+      } // draw
+
+      // uniform over [0, 1) with 53 bits of resolution
+      inline double uniform()
+      {
+        return static_cast<double>(gen_() >> 11) * 0x1.0p-53;
+      } // uniform
+
+      // Lemire's multiply-shift, as in RandomSet
+      inline std::uint64_t bounded(std::uint64_t word, std::uint64_t range)
+      {
+        unsigned __int128 m = static_cast<unsigned __int128>(word) * range;
+        if(static_cast<std::uint64_t>(m) < range)
+        {
+          const std::uint64_t threshold = (0 - range) % range;
+          while(static_cast<std::uint64_t>(m) < threshold)
+          {
+            m = static_cast<unsigned __int128>(gen_()) * range;
+          }
+        }
+        return static_cast<std::uint64_t>(m >> 64);
+      } // bounded
+
+      // the weighted elements, densely packed
+      std::vector<entry_t> dense_;
+      // a map from an element to its position in the dense vector
+      FlatIndex<Index> index_;
+      // weight class buckets, indexed by class
+      std::vector<bucket_t> buckets_;
+      // the classes with members of positive weight
+      std::vector<std::uint32_t> active_;
+      // element hash
+      Hash hash_;
+      // randomization source
+      Generator gen_;
+
+    }; // WeightedRandomSet
+
+  } // demo::algo1
+
+// *EOF*
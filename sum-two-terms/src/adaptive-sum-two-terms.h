@@ -0,0 +1,332 @@
+// adaptive-sum-two-terms.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "parallel-sum-two-terms.h"
+  #include "sum-two-terms.h"
+  #include <algorithm>
+  #include <array>
+  #include <cerrno>
+  #include <cmath>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <fstream>
+  #include <string>
+  #include <system_error>
+  #include <type_traits>
+  #include <vector>
+
+  // ==========================================================================
+  // has_two_sum_terms (Algorithm 5)
+  // ==========================================================================
+  //
+  //   returns true if there exists elements m and n in sequence xs such that
+  //                sum = m + n, where xs and sum are given, by whichever of
+  //                the algorithms above suits xs
+  //
+  //   inputs:
+  //
+  //     xs : vector<T>           - a sequence of terms to consider
+  //
+  //     sum : T                  - the specified target sum for testing terms
+  //
+  //     thresholds : Thresholds  - the crossovers between the strategies
+  //                                (Dispatcher, optional)
+  //
+  //   template paramters:
+  //
+  //     T : class                - the (integral) data type of the terms and sum
+  //
+  //   returns:
+  //
+  //     has_terms : bool         - true  if the input sequence contains two
+  //                                      elements equal to a given sum
+  //                                false otherwise
+  //
+  // --------------------------------------------------------------------------
+  //
+  //
+  // Background:
+  //
+  //   The notes to algorithms 1 and 2 say which wins where:  the bitset of
+  //     algorithm 1 costs N + R/64 for a range of R values, and so wins
+  //     while the range is within some multiple of the number of terms;
+  //     the compliment table of algorithm 2 costs N probes, each a cache
+  //     miss once its U distinct terms outgrow the cache; and sorting
+  //     the terms and sweeping two pointers inward (as algorithm 3 does
+  //     once for many sums) costs N log N in sequential passes, whatever U.
+  //
+  //   The size and range of xs are found exactly in one pass.  The number
+  //     of distinct terms is estimated in another by HyperLogLog:  each
+  //     term is hashed, the leading bits of the hash choose a register,
+  //     and the register keeps the longest run of leading zeros seen in
+  //     the remaining bits.  A run of r zeros turns up about once in 2^r
+  //     distinct terms, and the harmonic mean of the registers gives an
+  //     estimate within about 1.04/sqrt(registers) (3% for 1024), from 1
+  //     KiB of state, however many terms repeat.
+  //
+  //   Where the crossovers fall depends on the cache and memory of the
+  //     host, and so they are measured on it:  the calibration benchmark
+  //     (sum-two-terms-calibrate.cc, make calibrate) times the strategies
+  //     against each other and writes the crossovers to a file, read back
+  //     by Thresholds::load.
+  //
+  //
+  // Implementation:
+  //
+  //   A sum outside [2 min, 2 max] is answered at once.  Otherwise choose:
+  //
+  //     bitset  while R <= bins_per_term N, and R <= bitset_bins
+  //                                         (algorithm 1, SequenceCheck)
+  //     hash    while U <= hash_distinct    (algorithm 2)
+  //     sort    otherwise                   (sort and two-pointer sweep)
+  //
+  //   estimating U only when neither the bitset nor (with N within the
+  //     threshold) the table is chosen outright.  The cap bitset_bins
+  //     bounds the memory of the bitset (at R/8 bytes) however many terms
+  //     there are, and is itself held within SequenceCheck::max_bins, past
+  //     which the bitset would be refused.  The Dispatcher keeps the
+  //     bitset, the compliment table, and the sorted copy between calls.
+  //     The default thresholds were fitted on the development host;
+  //     Thresholds::host reads those of the file named by
+  //     SUM_TWO_TERMS_THRESHOLDS instead, where it is set.
+  //
+  //
+  // Performance:
+  //
+  //   For a sequence xs, having N elements, U of them distinct, spanning
+  //     R values, the time of the strategy chosen, plus:
+  //
+  //     range time complexity:            O(N)
+  //     estimate time complexity:         O(N)   (for the sort, or close)
+  //
+  //     space complexity:                 O(1), plus that of the strategy
+  //
+  //
+  namespace demo::algo5 {
+
+    // ==========================================================================
+    // DistinctEstimate
+    // ==========================================================================
+    //
+    //   a HyperLogLog estimate of the number of distinct 64-bit hashes added
+    //     (2^precision registers, with the small-range correction by linear
+    //     counting while registers are still empty)
+    //
+    class DistinctEstimate
+    {
+     public:
+
+      static constexpr unsigned precision = 10;
+      static constexpr std::size_t registers = std::size_t(1) << precision;
+
+      inline void add(const std::uint64_t hash)
+      {
+        const std::size_t r = hash >> (64 - precision);
+        // leading zeros of the rest, plus one, capped by its width
+        const std::uint64_t rest = hash << precision;
+        const std::uint8_t rank = rest ? __builtin_clzll(rest) + 1 : 64 - precision + 1;
+        registers_[r] = std::max(registers_[r], rank);
+      } // add
+
+      inline double estimate() const
+      {
+        const double m = registers;
+        double harmonic = 0;
+        std::size_t zeros = 0;
+        for(auto r : registers_)
+        {
+          harmonic += std::ldexp(1.0, -static_cast<int>(r));
+          zeros    += (0 == r);
+        }
+        const double e = 0.7213 / (1 + 1.079 / m) * m * m / harmonic;
+        if(e <= 2.5 * m && zeros) return m * std::log(m / zeros);
+        return e;
+      } // estimate
+
+     private:
+
+      std::array<std::uint8_t, registers> registers_{};
+
+    }; // DistinctEstimate
+
+    enum class Strategy { bitset, hash, sort };
+
+    inline const char *name(const Strategy strategy)
+    {
+      switch(strategy)
+      {
+        case Strategy::bitset: return "bitset";
+        case Strategy::hash:   return "hash";
+        case Strategy::sort:   return "sort";
+      }
+      return "unknown";
+    } // name
+
+    // ==========================================================================
+    // Thresholds
+    // ==========================================================================
+    //
+    //   the crossovers between the strategies, stored as lines of a name and
+    //     a value (names not known are skipped, and values not given keep
+    //     their defaults); failures to read or write the file throw
+    //     std::system_error
+    //
+    struct Thresholds
+    {
+      // the bitset, while the range of terms is at most this many per term
+      double bins_per_term = 2048;
+      // the compliment table, while the distinct terms are at most this many
+      double hash_distinct = 1 << 24;
+      // the bitset, while the range of terms is at most this many in all
+      //   (256 MiB of bits, and never past SequenceCheck::max_bins)
+      double bitset_bins = double(std::size_t(1) << 31);
+
+      static inline Thresholds load(const std::string &path)
+      {
+        std::ifstream is(path);
+        if(!is) throw std::system_error(errno, std::generic_category(), path);
+        Thresholds thresholds;
+        std::string key;
+        double value;
+        while(is >> key >> value)
+        {
+          if(key == "bins_per_term") thresholds.bins_per_term = value;
+          if(key == "hash_distinct") thresholds.hash_distinct = value;
+          if(key == "bitset_bins")   thresholds.bitset_bins   = value;
+        }
+        return thresholds;
+      } // load
+
+      inline void save(const std::string &path) const
+      {
+        std::ofstream os(path);
+        if(!os) throw std::system_error(errno, std::generic_category(), path);
+        os.precision(17);
+        os << "bins_per_term " << bins_per_term << std::endl
+           << "hash_distinct " << hash_distinct << std::endl
+           << "bitset_bins "   << bitset_bins   << std::endl;
+        if(!os) throw std::system_error(errno, std::generic_category(), path);
+      } // save
+
+      // those of the file named by SUM_TWO_TERMS_THRESHOLDS, where it is
+      //   set, or the defaults otherwise
+      static inline Thresholds host()
+      {
+        const char *path = std::getenv("SUM_TWO_TERMS_THRESHOLDS");
+        return path ? load(path) : Thresholds();
+      } // host
+
+    }; // Thresholds
+
+    template<class T>
+    class Dispatcher
+    {
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+
+      // wide enough for the sum (or difference) of any two terms
+      typedef __int128 wide_t;
+
+     public:
+
+      explicit Dispatcher(const Thresholds &thresholds = Thresholds())
+       : thresholds_(thresholds)
+       {};
+
+      // the strategy suited to xs
+      inline Strategy choose(const std::vector<T> &xs) const
+      {
+        if(xs.empty()) return Strategy::hash;
+        const auto [least, greatest] = range(xs);
+        return choose(xs, least, greatest);
+      } // choose
+
+      inline bool has_two_sum_terms(const std::vector<T> &xs, const T sum)
+      {
+        if(xs.size() < 2) return false;
+        // no two terms reach a sum outside [2 min, 2 max]
+        const auto [least, greatest] = range(xs);
+        if(sum < 2*static_cast<wide_t>(least) || sum > 2*static_cast<wide_t>(greatest)) return false;
+        return run(choose(xs, least, greatest), xs, sum);
+      } // has_two_sum_terms
+
+      // decides the sum by the given strategy
+      inline bool run(const Strategy strategy, const std::vector<T> &xs, const T sum)
+      {
+        switch(strategy)
+        {
+          case Strategy::bitset: return bitset_.has_two_sum_terms(xs, sum);
+          case Strategy::hash:   return algo2::has_two_sum_terms(xs, sum, compliments_);
+          case Strategy::sort:   return sorted_sweep(xs, sum);
+        }
+        return false;
+      } // run
+
+     private:
+
+      // the strategy suited to xs, spanning [least, greatest]
+      inline Strategy choose(const std::vector<T> &xs, const T least, const T greatest) const
+      {
+        const double bins = static_cast<double>(static_cast<wide_t>(greatest) - least) + 1;
+        // within the per-term threshold, the memory cap, and what the
+        //   bitset accepts at all
+        const double cap = std::min(thresholds_.bitset_bins,
+                                    static_cast<double>(algo1::SequenceCheck<T>::max_bins));
+        if(bins <= thresholds_.bins_per_term * xs.size() && bins <= cap) return Strategy::bitset;
+        // no more distinct terms than terms
+        if(xs.size() <= thresholds_.hash_distinct) return Strategy::hash;
+        DistinctEstimate distinct;
+        for(auto x : xs) distinct.add(algo2::mix(static_cast<std::uint64_t>(x)));
+        return (distinct.estimate() <= thresholds_.hash_distinct) ? Strategy::hash : Strategy::sort;
+      } // choose
+
+      // least and greatest terms, in a branch-free pass
+      static inline std::pair<T, T> range(const std::vector<T> &xs)
+      {
+        T least = xs[0], greatest = xs[0];
+        for(auto x : xs)
+        {
+          least    = std::min(least, x);
+          greatest = std::max(greatest, x);
+        }
+        return { least, greatest };
+      } // range
+
+      // sorts a copy of the terms, and sweeps two pointers inward over its
+      //   positions (so equal terms at two positions pair)
+      inline bool sorted_sweep(const std::vector<T> &xs, const T sum)
+      {
+        sorted_.assign(xs.begin(), xs.end());
+        std::sort(sorted_.begin(), sorted_.end());
+        if(sorted_.size() < 2) return false;
+        for(std::size_t i=0, j=sorted_.size()-1; i < j; )
+        {
+          const wide_t t = static_cast<wide_t>(sorted_[i]) + sorted_[j];
+          if(t == sum) return true;
+          if(t < sum) ++i; else --j;
+        } // two-pointer sweep i < j
+        return false; // otherwise no such two terms
+      } // sorted_sweep
+
+      Thresholds thresholds_;
+      // algorithm 1, its bitset kept between calls
+      algo1::SequenceCheck<T> bitset_;
+      // algorithm 2, its table kept between calls
+      algo2::ComplementTable<T> compliments_;
+      // the sorted copy of the terms, kept between calls
+      std::vector<T> sorted_;
+
+    }; // Dispatcher
+
+    // by a dispatcher per thread, with the host's thresholds
+    template<class T>
+    bool has_two_sum_terms(const std::vector<T> &xs, const T sum)
+    {
+      thread_local Dispatcher<T> dispatcher(Thresholds::host());
+      return dispatcher.has_two_sum_terms(xs, sum);
+    } // has_two_sum_terms
+
+  } // demo::algo5
+
+// *EOF*
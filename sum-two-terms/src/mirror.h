@@ -0,0 +1,162 @@
+// mirror.h
+// Mac Radigan
+
+  #pragma once
+
+  #include <cstddef>
+  #include <cstdint>
+
+  #if defined(__x86_64__)
+  #include <immintrin.h>
+  #endif
+
+  // ==========================================================================
+  // mirror
+  // ==========================================================================
+  //
+  //   tests a bitset against its own reflection about a point:  whether
+  //     there is a bit k, in a range of words, with both bit k and bit
+  //     p - k set
+  //
+  //   with bits k of a histogram marking the values present (offset by the
+  //     least of the pairing window), and p the offset target sum, this is the test for two terms
+  //     summing to the target, 64 bins per word
+  //
+  //   word w of the reflection holds the bits p - 64w - 63 ... p - 64w of the
+  //     bitset, in reverse order:  an unaligned 64-bit window, funnel-shifted
+  //     out of two adjacent words, then bit-reversed
+  //
+  //   kernel     words per step  bit reversal
+  //   scalar      1              byte swap, then swaps of nibbles, pairs, bits
+  //   avx2        4              byte shuffle, then nibble table shuffles
+  //   avx512      8              byte shuffle, then nibble table shuffles
+  //
+  //   each kernel returns on the first step with a common bit.  the kernel
+  //     is chosen on first use from the instruction sets the processor
+  //     supports, whatever the compiler was targeting
+  //
+  //   the caller guarantees, for every word w in range, that the reflected
+  //     bits lie within the bitset, and that the word after them can be
+  //     read (a zero word padding the end of the bitset suffices)
+  //
+  namespace demo::mirror {
+
+    typedef bool (*kernel_t)(const std::uint64_t *bits, std::size_t p, std::size_t first, std::size_t last);
+
+    inline std::uint64_t reverse(std::uint64_t x)
+    {
+      x = __builtin_bswap64(x);
+      x = ((x >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((x & 0x0f0f0f0f0f0f0f0fULL) << 4);
+      x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+      x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+      return x;
+    } // reverse
+
+    // word w of the reflection of bits about p (bit p - 64w - 63 and up)
+    inline std::uint64_t reflect(const std::uint64_t *bits, std::size_t p, std::size_t w)
+    {
+      const std::size_t e = p - 64*w - 63;
+      const unsigned r = e % 64;
+      const std::uint64_t window = r ? (bits[e/64] >> r) | (bits[e/64 + 1] << (64 - r)) : bits[e/64];
+      return reverse(window);
+    } // reflect
+
+    // true if bits[w] and its reflection share a bit, for some first <= w < last
+    inline bool scalar(const std::uint64_t *bits, std::size_t p, std::size_t first, std::size_t last)
+    {
+      for(std::size_t w=first; w<last; ++w) if(bits[w] & reflect(bits, p, w)) return true;
+      return false;
+    } // scalar
+
+  #if defined(__x86_64__)
+
+    __attribute__((target("avx2")))
+    inline bool avx2(const std::uint64_t *bits, std::size_t p, std::size_t first, std::size_t last)
+    {
+      // bits reversed within each nibble, and bytes reversed within each lane
+      const __m256i nibbles  = _mm256_setr_epi8(0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf,
+                                                0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf);
+      const __m256i bytes    = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+      const __m256i low      = _mm256_set1_epi8(0x0f);
+      std::size_t w = first;
+      if(last - first >= 4)
+      {
+        // the in-word shift of the window is common to all words
+        const unsigned r = (p - 64*first - 63) % 64;
+        const __m128i right = _mm_cvtsi32_si128(r);
+        const __m128i left  = _mm_cvtsi32_si128(64 - r); // a shift of 64 clears
+        for(; w + 4 <= last; w += 4)
+        {
+          // windows of words w+3 ... w, from the words they span
+          const std::size_t q = (p - 64*(w + 3) - 63) / 64;
+          const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + q));
+          const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + q + 1));
+          __m256i x = _mm256_or_si256(_mm256_srl_epi64(lo, right), _mm256_sll_epi64(hi, left));
+          // reverse all 256 bits:  the lanes, the bytes in each, the bits in each
+          x = _mm256_permute4x64_epi64(x, 0x4e);
+          x = _mm256_shuffle_epi8(x, bytes);
+          x = _mm256_or_si256(_mm256_slli_epi16(_mm256_shuffle_epi8(nibbles, _mm256_and_si256(x, low)), 4),
+                              _mm256_shuffle_epi8(nibbles, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+          const __m256i forward = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + w));
+          if(!_mm256_testz_si256(forward, x)) return true;
+        }
+      }
+      return scalar(bits, p, w, last);
+    } // avx2
+
+    __attribute__((target("avx512f,avx512bw")))
+    inline bool avx512(const std::uint64_t *bits, std::size_t p, std::size_t first, std::size_t last)
+    {
+      const __m512i nibbles  = _mm512_broadcast_i32x4(_mm_setr_epi8(0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+                                                                    0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf));
+      const __m512i bytes    = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+      const __m512i lanes    = _mm512_setr_epi64(6, 7, 4, 5, 2, 3, 0, 1);
+      const __m512i low      = _mm512_set1_epi8(0x0f);
+      std::size_t w = first;
+      if(last - first >= 8)
+      {
+        const unsigned r = (p - 64*first - 63) % 64;
+        const __m128i right = _mm_cvtsi32_si128(r);
+        const __m128i left  = _mm_cvtsi32_si128(64 - r);
+        for(; w + 8 <= last; w += 8)
+        {
+          const std::size_t q = (p - 64*(w + 7) - 63) / 64;
+          const __m512i lo = _mm512_loadu_si512(bits + q);
+          const __m512i hi = _mm512_loadu_si512(bits + q + 1);
+          __m512i x = _mm512_or_si512(_mm512_srl_epi64(lo, right), _mm512_sll_epi64(hi, left));
+          x = _mm512_permutexvar_epi64(lanes, x);
+          x = _mm512_shuffle_epi8(x, bytes);
+          x = _mm512_or_si512(_mm512_slli_epi16(_mm512_shuffle_epi8(nibbles, _mm512_and_si512(x, low)), 4),
+                              _mm512_shuffle_epi8(nibbles, _mm512_and_si512(_mm512_srli_epi16(x, 4), low)));
+          const __m512i forward = _mm512_loadu_si512(bits + w);
+          if(_mm512_test_epi64_mask(forward, x)) return true;
+        }
+      }
+      return scalar(bits, p, w, last);
+    } // avx512
+
+  #endif
+
+    // the widest kernel the processor supports
+    inline kernel_t select()
+    {
+  #if defined(__x86_64__)
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return avx512;
+      if(__builtin_cpu_supports("avx2")) return avx2;
+  #endif
+      return scalar;
+    } // select
+
+    // true if bits[w] and its reflection about p share a bit, for some
+    //   first <= w < last
+    inline bool any(const std::uint64_t *bits, std::size_t p, std::size_t first, std::size_t last)
+    {
+      static const kernel_t kernel = select();
+      return kernel(bits, p, first, last);
+    } // any
+
+  } // demo::mirror
+
+// *EOF*
@@ -0,0 +1,463 @@
+// parallel-sum-two-terms.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "sum-two-terms.h"
+  #include <algorithm>
+  #include <atomic>
+  #include <cerrno>
+  #include <condition_variable>
+  #include <cstdint>
+  #include <fcntl.h>
+  #include <iterator>
+  #include <limits>
+  #include <memory>
+  #include <mutex>
+  #include <string>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <system_error>
+  #include <thread>
+  #include <type_traits>
+  #include <unistd.h>
+  #include <vector>
+
+  namespace demo::algo2 {
+
+    // ==========================================================================
+    // ComplementSet
+    // ==========================================================================
+    //
+    //   a flat open-addressing set of terms (linear probing, at most half
+    //     full), for the streaming algorithm 2, where only membership is
+    //     needed:  the ComplementTable without positions, in half the space
+    //
+    //   an empty slot holds a sentinel value; the sentinel itself, when
+    //     inserted, is recorded by a flag instead
+    //
+    template<class T>
+    class ComplementSet
+    {
+      static constexpr T empty = std::numeric_limits<T>::max();
+
+     public:
+
+      explicit ComplementSet(std::size_t capacity = 16)
+      {
+        std::size_t slots = 16;
+        while(slots < 2*capacity) slots <<= 1;
+        slots_.assign(slots, empty);
+      };
+
+      inline bool contains(const T x) const
+      {
+        if(x == empty) return has_empty_;
+        const std::size_t mask = slots_.size() - 1;
+        for(std::size_t i = mix(static_cast<std::uint64_t>(x)) & mask; ; i = (i + 1) & mask)
+        {
+          if(slots_[i] == x) return true;
+          if(slots_[i] == empty) return false;
+        }
+      } // contains
+
+      // inserts a term, returning false if it was already present
+      inline bool insert(const T x)
+      {
+        if(x == empty)
+        {
+          if(has_empty_) return false;
+          return has_empty_ = true;
+        }
+        if(2*(size_ + 1) > slots_.size()) grow();
+        const std::size_t mask = slots_.size() - 1;
+        for(std::size_t i = mix(static_cast<std::uint64_t>(x)) & mask; ; i = (i + 1) & mask)
+        {
+          if(slots_[i] == x) return false;
+          if(slots_[i] == empty)
+          {
+            slots_[i] = x;
+            ++size_;
+            return true;
+          }
+        }
+      } // insert
+
+      // the number of terms in the set
+      inline std::size_t size() const
+      {
+        return size_ + has_empty_;
+      } // size
+
+      inline void clear()
+      {
+        std::fill(slots_.begin(), slots_.end(), empty);
+        size_      = 0;
+        has_empty_ = false;
+      } // clear
+
+     private:
+
+      inline void grow()
+      {
+        std::vector<T> old(2*slots_.size(), empty);
+        old.swap(slots_);
+        size_ = 0;
+        for(auto x : old) if(x != empty) insert(x);
+      } // grow
+
+      std::vector<T> slots_;
+      std::size_t size_ = 0;
+      bool has_empty_ = false;
+
+    }; // ComplementSet
+
+    // ==========================================================================
+    // has_two_sum_terms (Algorithm 2, streaming)
+    // ==========================================================================
+    //
+    //   algorithm 2 over a sequence read once, front to back, from an input
+    //     iterator or in chunks, so that the sequence need never be held in
+    //     memory:  only the compliments of the distinct terms seen are kept
+    //
+    //   StreamCheck holds the compliments for one sum across chunks; consume
+    //     returns true as soon as a pair is found, after which the rest of
+    //     the sequence need not be read
+    //
+    //   a term whose compliment is not representable in T (the subtraction
+    //     overflows) can pair with no term, and is not recorded
+    //
+    template<class T>
+    class StreamCheck
+    {
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+
+     public:
+
+      explicit StreamCheck(const T sum)
+       : sum_(sum)
+       {};
+
+      // reads terms up to last, or until a pair is found
+      template<class InputIt>
+      inline bool consume(InputIt first, InputIt last)
+      {
+        for(; !found_ && first != last; ++first)
+        {
+          const T x = *first;
+          if(compliments_.contains(x)) found_ = true;
+          T c;
+          if(!__builtin_sub_overflow(sum_, x, &c)) compliments_.insert(c);
+        }
+        return found_;
+      } // consume
+
+      // true once two terms summing to the sum have been read
+      inline bool found() const
+      {
+        return found_;
+      } // found
+
+     private:
+
+      T sum_;
+      ComplementSet<T> compliments_;
+      bool found_ = false;
+
+    }; // StreamCheck
+
+    template<class InputIt>
+    bool has_two_sum_terms(InputIt first, InputIt last, const typename std::iterator_traits<InputIt>::value_type sum)
+    {
+      StreamCheck<typename std::iterator_traits<InputIt>::value_type> check(sum);
+      return check.consume(first, last);
+    } // has_two_sum_terms
+
+    // ==========================================================================
+    // MappedSequence
+    // ==========================================================================
+    //
+    //   a read-only memory mapping of a file of terms, in the native
+    //     representation of T, as a random-access range:  pages are read
+    //     in as the range is scanned (advised as sequential), and dropped
+    //     by the kernel under memory pressure, so a sequence larger than
+    //     memory may be scanned by the streaming or parallel algorithms
+    //
+    //   failures to open or map the file throw std::system_error
+    //
+    template<class T>
+    class MappedSequence
+    {
+     public:
+
+      explicit MappedSequence(const std::string &path)
+      {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if(::fstat(fd, &st) < 0)
+        {
+          const int error = errno;
+          ::close(fd);
+          throw std::system_error(error, std::generic_category(), path);
+        }
+        bytes_ = static_cast<std::size_t>(st.st_size);
+        if(bytes_)
+        {
+          void *p = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+          if(MAP_FAILED == p)
+          {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+          }
+          ::madvise(p, bytes_, MADV_SEQUENTIAL);
+          data_ = static_cast<const T*>(p);
+        }
+        ::close(fd);
+      };
+
+      MappedSequence(const MappedSequence&) = delete;
+      MappedSequence& operator=(const MappedSequence&) = delete;
+
+      ~MappedSequence()
+      {
+        if(data_) ::munmap(const_cast<T*>(data_), bytes_);
+      } // ~MappedSequence
+
+      inline const T* begin() const { return data_; };
+      inline const T* end() const { return data_ + size(); };
+
+      // the number of whole terms in the file
+      inline std::size_t size() const
+      {
+        return bytes_ / sizeof(T);
+      } // size
+
+     private:
+
+      const T *data_ = nullptr;
+      std::size_t bytes_ = 0;
+
+    }; // MappedSequence
+
+  } // demo::algo2
+
+
+  // ==========================================================================
+  // has_two_sum_terms (Algorithm 4)
+  // ==========================================================================
+  //
+  //   returns true if there exists elements m and n in sequence xs such that
+  //                sum = m + n, where xs and sum are given, using several
+  //                threads
+  //
+  //   inputs:
+  //
+  //     first, last : RandomIt  - a sequence of terms to consider (e.g. a
+  //                                 vector, or a MappedSequence)
+  //
+  //     sum : T                 - the specified target sum for testing terms
+  //
+  //     threads : unsigned      - worker threads (0 for one per core)
+  //
+  //   returns:
+  //
+  //     has_terms : bool - true  if the input sequence contains two elements
+  //                              equal to a given sum
+  //                        false otherwise
+  //
+  // --------------------------------------------------------------------------
+  //
+  //
+  // Background:
+  //
+  //   Algorithm 2 is sequential:  every term probes and extends one table
+  //     of compliments.  But a term x can only pair with sum - x, and the
+  //     two share the key min(x, sum - x).  Partitioning the terms by a
+  //     hash of that key sends every term and its compliment to the same
+  //     partition, so each partition may run algorithm 2 on its own terms,
+  //     independently of the others, and a pair exists in the sequence if
+  //     and only if one is found in some partition.
+  //
+  //
+  // Implementation:
+  //
+  //   The sequence is divided into a slice per worker, and the slices
+  //     consumed in rounds of a chunk each.  In a round, each worker first
+  //     routes the terms of its chunk into a buffer per partition; then,
+  //     after a barrier, each worker takes the buffers of its own partition
+  //     from every worker and runs algorithm 2 over them against its own
+  //     table of compliments.  A second barrier hands the buffers back.
+  //
+  //   A worker finding a pair raises a shared flag; the others abandon
+  //     their partitions at the next term they take, and all stop at the
+  //     end of the round, when every worker sees the flag alike.
+  //
+  //   Should a worker thread fail to start, those started are withdrawn
+  //     from the barrier with the rest, joined, and the failure rethrown.
+  //
+  //   Terms whose compliment overflows T can pair with nothing and are
+  //     dropped when routed.
+  //
+  //
+  // Performance:
+  //
+  //   For a sequence xs, having N elements, D of them distinct, and P
+  //     workers, we have:
+  //
+  //     average time complexity:         O(N/P), plus a barrier per round
+  //     space complexity:                O(D), plus O(P^2) chunk buffers
+  //
+  //
+  //   Note that the routing pass reads each term once, from its slice
+  //     only, so scanning a mapped file is spread over the workers too.
+  //
+  //
+  namespace demo::algo4 {
+
+    // a reusable barrier for a fixed number of threads
+    class Barrier
+    {
+     public:
+
+      explicit Barrier(std::size_t count)
+       : count_(count)
+       {};
+
+      inline void wait()
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        const std::size_t generation = generation_;
+        if(++arrived_ == count_)
+        {
+          arrived_ = 0;
+          ++generation_;
+          released_.notify_all();
+          return;
+        }
+        released_.wait(lock, [&] { return generation != generation_; });
+      } // wait
+
+      // withdraws count threads that will never arrive, releasing those
+      //   waiting if they are now all that remain
+      inline void leave(std::size_t count)
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        count_ -= count;
+        if(arrived_ && arrived_ >= count_)
+        {
+          arrived_ = 0;
+          ++generation_;
+          released_.notify_all();
+        }
+      } // leave
+
+     private:
+
+      std::mutex lock_;
+      std::condition_variable released_;
+      std::size_t count_;
+      std::size_t arrived_ = 0;
+      std::size_t generation_ = 0;
+
+    }; // Barrier
+
+    // terms routed per worker per round
+    static constexpr std::size_t chunk = std::size_t(1) << 16;
+
+    template<class RandomIt>
+    bool has_two_sum_terms(RandomIt first, RandomIt last, const typename std::iterator_traits<RandomIt>::value_type sum, unsigned threads = 0)
+    {
+      typedef typename std::iterator_traits<RandomIt>::value_type T;
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+      typedef __int128 wide_t;
+
+      const std::size_t n = static_cast<std::size_t>(last - first);
+      std::size_t workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+      // no more workers than chunks
+      workers = std::max<std::size_t>(1, std::min(workers, (n + chunk - 1) / chunk));
+      if(1 == workers) return algo2::has_two_sum_terms(first, last, sum);
+
+      struct alignas(64) worker_t
+      {
+        algo2::ComplementSet<T> compliments;
+        // terms routed this round, by partition
+        std::vector<std::vector<T>> routed;
+      };
+      std::unique_ptr<worker_t[]> state(new worker_t[workers]);
+      for(std::size_t w=0; w<workers; ++w) state[w].routed.resize(workers);
+
+      const std::size_t slice  = (n + workers - 1) / workers;
+      const std::size_t rounds = (slice + chunk - 1) / chunk;
+      std::atomic<bool> found{false};
+      // raised should a worker thread fail to start, releasing the others
+      std::atomic<bool> aborted{false};
+      Barrier barrier(workers);
+
+      auto work = [&](std::size_t self) {
+        worker_t &mine = state[self];
+        for(std::size_t round=0; round<rounds; ++round)
+        {
+          // route the terms of this round's chunk of the slice by the hash
+          //   of the key they share with their compliment
+          const std::size_t begin = std::min(n, self*slice + round*chunk);
+          const std::size_t end   = std::min({ n, self*slice + slice, begin + chunk });
+          for(std::size_t k=begin; k<end; ++k)
+          {
+            const T x = first[k];
+            T c;
+            if(__builtin_sub_overflow(sum, x, &c)) continue;
+            const T key = std::min(x, c);
+            const std::size_t partition = static_cast<std::size_t>(
+              (static_cast<unsigned __int128>(algo2::mix(static_cast<std::uint64_t>(key))) * workers) >> 64);
+            mine.routed[partition].push_back(x);
+          }
+          barrier.wait();
+          if(aborted.load(std::memory_order_relaxed)) return;
+          // algorithm 2 over this partition's terms, from every worker,
+          //   stopping at once on a pair found by any
+          for(std::size_t from=0; from<workers && !found.load(std::memory_order_relaxed); ++from)
+          {
+            const std::vector<T> &terms = state[from].routed[self];
+            for(std::size_t k=0; k<terms.size() && !found.load(std::memory_order_relaxed); ++k)
+            {
+              if(mine.compliments.contains(terms[k]))
+              {
+                found.store(true, std::memory_order_relaxed);
+                break;
+              }
+              mine.compliments.insert(static_cast<T>(static_cast<wide_t>(sum) - terms[k]));
+            }
+          }
+          barrier.wait();
+          for(auto &buffer : mine.routed) buffer.clear();
+          if(found.load(std::memory_order_relaxed)) break;
+        }
+      }; // work
+
+      std::vector<std::thread> pool;
+      pool.reserve(workers - 1);
+      try
+      {
+        for(std::size_t w=1; w<workers; ++w) pool.emplace_back(work, w);
+      }
+      catch(...)
+      {
+        // the workers started wait at the first barrier for those that
+        //   never will (this thread among them):  withdraw those, so the
+        //   started ones are released to see the abort, and join them
+        //   before passing the failure on
+        aborted.store(true, std::memory_order_relaxed);
+        barrier.leave(workers - pool.size());
+        for(auto &t : pool) t.join();
+        throw;
+      }
+      work(0);
+      for(auto &t : pool) t.join();
+      return found.load();
+    } // has_two_sum_terms
+
+  } // demo::algo4
+
+// *EOF*
@@ -0,0 +1,203 @@
+// sum-two-terms-bench.cc
+// Mac Radigan
+
+
+  #include "adaptive-sum-two-terms.h"
+  #include "mirror.h"
+  #include "parallel-sum-two-terms.h"
+  #include "sum-two-terms.h"
+  #include <algorithm>
+  #include <chrono>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <cstring>
+  #include <iostream>
+  #include <random>
+  #include <string>
+  #include <thread>
+  #include <vector>
+
+  typedef int64_t element_t;
+
+  volatile std::size_t sink;
+
+  static inline double now()
+  {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  } // now
+
+  static inline void report(const char *name, const char *operation, std::size_t size, std::size_t ops, double seconds)
+  {
+    std::cout << name << "," << operation << "," << size << ",ops_per_sec," << static_cast<std::uint64_t>(ops / seconds) << std::endl;
+  } // report
+
+  // asks queries sums of size terms drawn from [0, range) (scaled by
+  //   scale), by algorithms 1 (within a 2^32 range), 2 and 5 per sum, and by
+  //   TwoSumIndex per sum (deciding, and counting pairs) and
+  //   batched; half of the sums are of two terms, the other half random
+  //   (offset by one, which with even terms makes them unreachable)
+  static void bench(const char *name, std::size_t size, element_t range, std::size_t queries, element_t scale = 1)
+  {
+    std::mt19937_64 gen(size);
+    std::uniform_int_distribution<element_t> terms(0, range - 1);
+    std::vector<element_t> xs(size);
+    for(auto &x : xs) x = scale * terms(gen);
+    std::vector<element_t> sums(queries);
+    for(std::size_t k=0; k<queries; ++k) sums[k] = (k & 1) ? xs[gen() % size] + xs[gen() % size] : scale * (terms(gen) + terms(gen)) + scale - 1;
+
+    std::size_t found = 0;
+    // the per-sum rebuilds, and counts (which sweep in full), are slow,
+    //   and timed on a prefix of the sums
+    const std::size_t rebuilt = std::min<std::size_t>(queries, 200);
+    double start;
+    if(range <= (element_t(1) << 32))
+    {
+      demo::algo1::SequenceCheck<element_t> check;
+      start = now();
+      for(std::size_t k=0; k<rebuilt; ++k) found += check.has_two_sum_terms(xs, sums[k]);
+      report(name, "algo1", size, rebuilt, now() - start);
+    }
+    start = now();
+    for(std::size_t k=0; k<rebuilt; ++k) found += demo::algo2::has_two_sum_terms(xs, sums[k]);
+    report(name, "algo2", size, rebuilt, now() - start);
+
+    demo::algo5::Dispatcher<element_t> adaptive(demo::algo5::Thresholds::host());
+    start = now();
+    for(std::size_t k=0; k<rebuilt; ++k) found += adaptive.has_two_sum_terms(xs, sums[k]);
+    const std::string chosen = std::string("algo5_") + demo::algo5::name(adaptive.choose(xs));
+    report(name, chosen.c_str(), size, rebuilt, now() - start);
+
+    start = now();
+    demo::algo3::TwoSumIndex<element_t> index(xs, 0);
+    for(auto s : sums) found += index.has_two_sum_terms(s);
+    report(name, "index_sweep", size, queries, now() - start);
+
+    start = now();
+    for(std::size_t k=0; k<rebuilt; ++k) found += index.count_pairs(sums[k]);
+    report(name, "index_count", size, rebuilt, now() - start);
+
+    start = now();
+    demo::algo3::TwoSumIndex<element_t> batch(xs);
+    const auto answers = batch.query(sums);
+    for(bool a : answers) found += a;
+    report(name, "index_query", size, queries, now() - start);
+    sink = found;
+  } // bench
+
+  // find_terms for three and four of size even terms (from a range of
+  //   size squared, so that most sums of four are distinct) and odd sums
+  //   about as large as theirs, never found:  the recursive sweep, and
+  //   the pair sums (formed once, and timed with the first sum)
+  static void bench_terms(std::size_t size, std::size_t queries)
+  {
+    std::mt19937_64 gen(size);
+    std::uniform_int_distribution<element_t> terms(0, static_cast<element_t>(size * size));
+    std::vector<element_t> xs(size);
+    for(auto &x : xs) x = 2 * terms(gen);
+    demo::algo3::TwoSumIndex<element_t> recursive(xs, 0);
+    demo::algo3::TwoSumIndex<element_t> paired(xs, std::size_t(1) << 24);
+    std::size_t found = 0;
+    for(std::size_t k : { 3, 4 })
+    {
+      // sums of k terms drawn alike, plus one
+      std::vector<element_t> sums(queries, 1);
+      for(auto &s : sums) for(std::size_t n=0; n<k; ++n) s += 2 * terms(gen);
+      const std::string name = "terms_" + std::to_string(k);
+      double start = now();
+      for(auto s : sums) found += recursive.find_terms(s, k).has_value();
+      report(name.c_str(), "recursive", size, queries, now() - start);
+      if(4 != k) continue;
+      start = now();
+      for(auto s : sums) found += paired.find_terms(s, k).has_value();
+      report(name.c_str(), "pair_sums", size, queries, now() - start);
+    }
+    sink = found;
+  } // bench_terms
+
+  // scan throughput of each mirror kernel over a histogram of bins bins,
+  //   every other bin set and an odd reflection point, so that no pair is
+  //   found and every kernel runs the whole range
+  static void bench_mirror(std::size_t bins)
+  {
+    const std::size_t words = bins / 64;
+    std::vector<std::uint64_t> bits(words + 1, 0x5555555555555555ULL);
+    bits[words] = 0;
+    const std::size_t p = 64*words - 1;
+    std::vector<std::pair<const char*, demo::mirror::kernel_t>> kernels = { { "scalar", demo::mirror::scalar } };
+  #if defined(__x86_64__)
+    if(__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", demo::mirror::avx2 });
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) kernels.push_back({ "avx512", demo::mirror::avx512 });
+  #endif
+    for(auto &kernel : kernels)
+    {
+      const int rounds = 20;
+      std::size_t found = 0;
+      const double start = now();
+      for(int r=0; r<rounds; ++r) found += kernel.second(bits.data(), p, 0, words/2);
+      const double seconds = now() - start;
+      sink = found;
+      std::cout << "mirror_" << kernel.first << ",scan," << bins << ",bins_per_sec,"
+                << static_cast<std::uint64_t>(rounds * 64.0 * (words/2) / seconds) << std::endl;
+    }
+  } // bench_mirror
+
+  // one sum over size odd terms, never found so that the whole sequence
+  //   is read:  algorithm 2 (cold, and reusing its table), streaming, and
+  //   by worker count in parallel
+  static void bench_stream(std::size_t size)
+  {
+    std::mt19937_64 gen(size);
+    std::vector<element_t> xs(size);
+    for(auto &x : xs) x = 2 * static_cast<element_t>(gen() >> 4) + 1;
+    const element_t sum = 1;
+    std::size_t found = 0;
+
+    // the first call grows the table passed in, and later calls reuse it
+    demo::algo2::ComplementTable<element_t> compliments;
+    double start = now();
+    found += demo::algo2::has_two_sum_terms(xs, sum, compliments);
+    report("stream", "algo2", size, size, now() - start);
+    start = now();
+    found += demo::algo2::has_two_sum_terms(xs, sum, compliments);
+    report("stream", "algo2_warm", size, size, now() - start);
+
+    // the first pass of the growing tables faults in fresh pages, and is
+    //   not timed
+    found += demo::algo2::has_two_sum_terms(xs.begin(), xs.end(), sum);
+    start = now();
+    found += demo::algo2::has_two_sum_terms(xs.begin(), xs.end(), sum);
+    report("stream", "streaming", size, size, now() - start);
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned threads=1; threads<=std::max(4u, cores); threads*=2)
+    {
+      start = now();
+      found += demo::algo4::has_two_sum_terms(xs.begin(), xs.end(), sum, threads);
+      const std::string name = "parallel_" + std::to_string(threads);
+      report(name.c_str(), "algo4", size, size, now() - start);
+    }
+    sink = found;
+  } // bench_stream
+
+  //
+  // main benchmark driver
+  //
+  int main(int argc, char *argv[])
+  {
+    // number of terms, e.g. -n 1000000
+    std::size_t size = 100000;
+    for(int k=1; k<argc-1; ++k) if(0 == std::strcmp(argv[k], "-n")) size = std::strtoull(argv[k+1], nullptr, 10);
+
+    std::cout << "implementation,operation,size,metric,value" << std::endl;
+    bench("dense", size, static_cast<element_t>(size) * 4, 100000);
+    bench("sparse", size, element_t(1) << 40, 10000);
+    bench("even", size, static_cast<element_t>(size) * 4, 10000, 2);
+    bench_terms(std::min<std::size_t>(size, 400), 10);
+    bench_mirror(std::size_t(1) << 20);
+    bench_mirror(std::size_t(1) << 30);
+    bench_stream(size * 100);
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
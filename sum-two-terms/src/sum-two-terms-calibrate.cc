@@ -0,0 +1,113 @@
+// sum-two-terms-calibrate.cc
+// Mac Radigan
+
+
+  #include "adaptive-sum-two-terms.h"
+  #include <algorithm>
+  #include <chrono>
+  #include <cmath>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <cstring>
+  #include <iostream>
+  #include <random>
+  #include <string>
+  #include <vector>
+
+  typedef int64_t element_t;
+
+  typedef demo::algo5::Strategy strategy_t;
+
+  volatile std::size_t sink;
+
+  static inline double now()
+  {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  } // now
+
+  // the least of a few timings of one unreachable sum by the strategy, in
+  //   seconds per term
+  static double seconds_per_term(demo::algo5::Dispatcher<element_t> &dispatcher, strategy_t strategy, const std::vector<element_t> &xs, element_t sum)
+  {
+    double best = 1e300;
+    for(int round=0; round<3; ++round)
+    {
+      const double start = now();
+      sink = dispatcher.run(strategy, xs, sum);
+      best = std::min(best, now() - start);
+    }
+    std::cout << demo::algo5::name(strategy) << "," << xs.size() << ",ns_per_term," << 1e9 * best / xs.size() << std::endl;
+    return best / xs.size();
+  } // seconds_per_term
+
+  // size even terms, all distinct in all likelihood, drawn from [0, 2 range)
+  static std::vector<element_t> terms(std::size_t size, element_t range)
+  {
+    std::mt19937_64 gen(size ^ range);
+    std::uniform_int_distribution<element_t> draw(0, range - 1);
+    std::vector<element_t> xs(size);
+    for(auto &x : xs) x = 2 * draw(gen);
+    return xs;
+  } // terms
+
+  //
+  // main calibration driver:  fits the crossovers between the strategies of
+  //   algorithm 5 on this host, and writes them out, e.g.
+  //   -o sum-two-terms.thresholds
+  //
+  int main(int argc, char *argv[])
+  {
+    std::string path = "sum-two-terms.thresholds";
+    for(int k=1; k<argc-1; ++k) if(0 == std::strcmp(argv[k], "-o")) path = argv[k+1];
+
+    demo::algo5::Dispatcher<element_t> dispatcher;
+    demo::algo5::Thresholds fitted;
+    std::cout << "strategy,size,metric,value" << std::endl;
+
+    // the compliment table against sorting, by distinct terms (over a wide
+    //   range, and with an odd sum, never found):  the midpoint, on a log
+    //   scale, of the last size the table wins and the first of two in a
+    //   row it loses (a single loss being as likely noise, near a tie)
+    const std::size_t least_distinct = std::size_t(1) << 10;
+    const std::size_t most_distinct  = std::size_t(1) << 23;
+    fitted.hash_distinct = 2.0 * most_distinct;
+    std::size_t lost = 0;
+    for(std::size_t size=least_distinct; size<=most_distinct; size*=2)
+    {
+      const auto xs = terms(size, element_t(1) << 40);
+      const double hash = seconds_per_term(dispatcher, strategy_t::hash, xs, 1);
+      const double sort = seconds_per_term(dispatcher, strategy_t::sort, xs, 1);
+      if(sort >= hash) { lost = 0; continue; }
+      if(lost)
+      {
+        fitted.hash_distinct = lost / std::sqrt(2.0);
+        break;
+      }
+      lost = size;
+    }
+
+    // the bitset against the better of the others, by bins per term, with
+    //   the sum at the centre of the range so that the whole histogram is
+    //   scanned
+    const std::size_t size = std::size_t(1) << 18;
+    fitted.bins_per_term = 1;
+    for(std::size_t bins=1; bins<=(std::size_t(1) << 12); bins*=2)
+    {
+      const auto xs = terms(size, static_cast<element_t>(size * bins / 2));
+      const element_t sum = *std::min_element(xs.begin(), xs.end()) + *std::max_element(xs.begin(), xs.end()) + 1;
+      const double bitset = seconds_per_term(dispatcher, strategy_t::bitset, xs, sum);
+      const double other  = (size <= fitted.hash_distinct) ? seconds_per_term(dispatcher, strategy_t::hash, xs, sum)
+                                                           : seconds_per_term(dispatcher, strategy_t::sort, xs, sum);
+      if(bitset > other) break;
+      fitted.bins_per_term = bins;
+    }
+
+    fitted.save(path);
+    std::cout << "fitted,bins_per_term," << fitted.bins_per_term << std::endl
+              << "fitted,hash_distinct," << fitted.hash_distinct << std::endl
+              << "saved," << path << std::endl;
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
@@ -0,0 +1,545 @@
+// sum-two-terms-test.cc
+// Mac Radigan
+
+
+  #include "adaptive-sum-two-terms.h"
+  #include "mirror.h"
+  #include "parallel-sum-two-terms.h"
+  #include "sum-two-terms.h"
+  #include <algorithm>
+  #include <assert.h>
+  #include <cmath>
+  #include <cstdint>
+  #include <cstdio>
+  #include <cstdlib>
+  #include <iostream>
+  #include <iterator>
+  #include <limits>
+  #include <new>
+  #include <random>
+  #include <sstream>
+  #include <system_error>
+  #include <thread>
+  #include <unistd.h>
+  #include <vector>
+
+  typedef int64_t element_t;
+
+  // heap allocations made, counted by the replaced global operator new
+  static std::size_t allocations = 0;
+
+  void *operator new(std::size_t size)
+  {
+    ++allocations;
+    if(void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+  } // operator new
+
+  void operator delete(void *p) noexcept
+  {
+    std::free(p);
+  } // operator delete
+
+  void operator delete(void *p, std::size_t) noexcept
+  {
+    std::free(p);
+  } // operator delete
+
+  // the definition, directly:  two distinct positions whose terms sum to sum
+  template<class T>
+  static bool brute_force(const std::vector<T> &xs, T sum)
+  {
+    for(std::size_t i=0; i<xs.size(); ++i)
+    {
+      for(std::size_t j=i+1; j<xs.size(); ++j)
+      {
+        if(static_cast<__int128>(xs[i]) + xs[j] == sum) return true;
+      }
+    }
+    return false;
+  } // brute_force
+
+  // every pair of positions i < j whose terms sum to sum, in order
+  template<class T>
+  static std::vector<std::pair<std::size_t, std::size_t>> brute_pairs(const std::vector<T> &xs, T sum)
+  {
+    std::vector<std::pair<std::size_t, std::size_t>> found;
+    for(std::size_t i=0; i<xs.size(); ++i)
+    {
+      for(std::size_t j=i+1; j<xs.size(); ++j)
+      {
+        if(static_cast<__int128>(xs[i]) + xs[j] == sum) found.push_back({ i, j });
+      }
+    }
+    return found;
+  } // brute_pairs
+
+  // the pairs of positions an index enumerates for sum, in order, checked
+  //   against its count and the pair it finds
+  template<class T>
+  static std::vector<std::pair<std::size_t, std::size_t>> index_pairs(const demo::algo3::TwoSumIndex<T> &index, T sum)
+  {
+    std::vector<std::pair<std::size_t, std::size_t>> found;
+    index.for_each_pair(sum, [&](std::size_t i, std::size_t j) { found.push_back({ i, j }); });
+    assert(index.count_pairs(sum) == found.size());
+    std::size_t calls = 0;
+    index.for_each_pair(sum, [&](std::size_t, std::size_t) { ++calls; return false; });
+    assert(calls == std::min<std::size_t>(1, found.size()));
+    const auto pair = index.find_pair(sum);
+    assert(pair.has_value() == !found.empty());
+    if(pair) assert(std::find(found.begin(), found.end(), *pair) != found.end());
+    std::sort(found.begin(), found.end());
+    return found;
+  } // index_pairs
+
+  //
+  // TwoSumIndex (by sweep, and by sumset table), algorithms 1 and 2, and
+  //   the streaming algorithm 2 agree with the definition on random
+  //   sequences of terms drawn from [lo, hi], for every sum over a window
+  //   enclosing [2 lo, 2 hi], as do algorithm 5 and each of its
+  //   strategies, and TwoSumIndex enumerates and counts the very pairs of
+  //   positions
+  //
+  template<class T>
+  static void differential(const char *name, std::uint64_t seed, T lo, T hi, std::size_t n, bool with_algo1)
+  {
+    demo::algo1::SequenceCheck<T> check;
+    demo::algo5::Dispatcher<T> adaptive;
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<T> terms(lo, hi);
+    for(int trial=0; trial<20; ++trial)
+    {
+      std::vector<T> xs(gen() % n);
+      for(auto &x : xs) x = terms(gen);
+
+      // sums around and between every pair, plus the extremes of T
+      std::vector<T> sums = { std::numeric_limits<T>::min(), std::numeric_limits<T>::max() };
+      for(std::size_t k=0; k<200; ++k)
+      {
+        const __int128 s = static_cast<__int128>(terms(gen)) + terms(gen) + static_cast<int>(gen() % 3) - 1;
+        if(s >= std::numeric_limits<T>::min() && s <= std::numeric_limits<T>::max()) sums.push_back(static_cast<T>(s));
+      }
+
+      demo::algo3::TwoSumIndex<T> sweep(xs, 0);
+      demo::algo3::TwoSumIndex<T> table(xs);
+      const auto by_sweep = sweep.query(sums);
+      const auto by_table = table.query(std::vector<T>(sums));
+      for(std::size_t k=0; k<sums.size(); ++k)
+      {
+        const auto pairs = brute_pairs(xs, sums[k]);
+        const bool expect = !pairs.empty();
+        assert(index_pairs(sweep, sums[k]) == pairs);
+        assert(index_pairs(table, sums[k]) == pairs);
+        assert(by_sweep[k] == expect);
+        assert(by_table[k] == expect);
+        assert(sweep.has_two_sum_terms(sums[k]) == expect);
+        assert(table.has_two_sum_terms(sums[k]) == expect);
+        if(with_algo1) assert(check.has_two_sum_terms(xs, sums[k]) == expect);
+        assert(demo::algo2::has_two_sum_terms<T>(xs, sums[k]) == expect);
+        assert(demo::algo2::has_two_sum_terms(xs.begin(), xs.end(), sums[k]) == expect);
+        assert(demo::algo5::has_two_sum_terms(xs, sums[k]) == expect);
+        assert(adaptive.run(demo::algo5::Strategy::hash, xs, sums[k]) == expect);
+        assert(adaptive.run(demo::algo5::Strategy::sort, xs, sums[k]) == expect);
+        if(with_algo1) assert(adaptive.run(demo::algo5::Strategy::bitset, xs, sums[k]) == expect);
+      }
+    }
+    std::cout << "test differential " << name << " seed " << seed << " passed" << std::endl;
+  } // differential
+
+  //
+  // a batch large enough to repay the transform forms the sumset table,
+  //   and one too small does not, both answering alike
+  //
+  static void test_sumset()
+  {
+    std::vector<element_t> xs;
+    for(element_t x=-500; x<=500; x+=7) xs.push_back(x);
+    xs.push_back(3);
+    xs.push_back(3);
+    std::vector<element_t> sums;
+    for(element_t s=-1100; s<=1100; ++s) sums.push_back(s);
+
+    demo::algo3::TwoSumIndex<element_t> index(xs);
+    const auto one = index.query({ 6 });
+    assert(one.front());
+    const auto all = index.query(sums);
+    for(std::size_t k=0; k<sums.size(); ++k) assert(all[k] == brute_force(xs, sums[k]));
+    assert(index.size() == xs.size() - 1);
+
+    // without the table, sums out of order and repeated are answered in
+    //   their places
+    demo::algo3::TwoSumIndex<element_t> sweep(xs, 0);
+    std::vector<element_t> shuffled(sums.rbegin(), sums.rend());
+    shuffled.insert(shuffled.end(), sums.begin(), sums.end());
+    const auto swept = sweep.query(shuffled);
+    for(std::size_t k=0; k<shuffled.size(); ++k) assert(swept[k] == brute_force(xs, shuffled[k]));
+    std::cout << "test sumset passed" << std::endl;
+  } // test_sumset
+
+  //
+  // find_terms agrees with every choice of k positions, for k up to 5,
+  //   by the recursive sweep and (for four terms) by the pair sums, and
+  //   the positions it finds are distinct and sum to the target
+  //
+  template<class T>
+  static void test_terms(const char *name, T lo, T hi)
+  {
+    std::mt19937_64 gen(5);
+    std::uniform_int_distribution<T> terms(lo, hi);
+    for(int trial=0; trial<300; ++trial)
+    {
+      std::vector<T> xs(gen() % 11);
+      for(auto &x : xs) x = terms(gen);
+      demo::algo3::TwoSumIndex<T> recursive(xs, 0);
+      demo::algo3::TwoSumIndex<T> paired(xs);
+      for(std::size_t k=1; k<=5; ++k)
+      {
+        // the sums reachable by k terms, over every subset of k positions
+        std::vector<__int128> reached;
+        for(std::uint32_t subset=0; subset < (1u << xs.size()); ++subset)
+        {
+          if(static_cast<std::size_t>(__builtin_popcount(subset)) != k) continue;
+          __int128 t = 0;
+          for(std::size_t i=0; i<xs.size(); ++i) if(subset >> i & 1) t += xs[i];
+          reached.push_back(t);
+        }
+        for(__int128 s = static_cast<__int128>(k) * lo - 1; s <= static_cast<__int128>(k) * hi + 1; ++s)
+        {
+          if(s < std::numeric_limits<T>::min() || s > std::numeric_limits<T>::max()) continue;
+          const bool expect = std::find(reached.begin(), reached.end(), s) != reached.end();
+          for(auto *index : { &recursive, &paired })
+          {
+            const auto found = index->find_terms(static_cast<T>(s), k);
+            assert(found.has_value() == expect);
+            if(!found) continue;
+            assert(found->size() == k);
+            __int128 t = 0;
+            for(std::size_t n=0; n<k; ++n)
+            {
+              assert((*found)[n] < xs.size());
+              if(n) assert((*found)[n-1] < (*found)[n]);
+              t += xs[(*found)[n]];
+            }
+            assert(t == s);
+          }
+        }
+      }
+    }
+    std::cout << "test terms " << name << " passed" << std::endl;
+  } // test_terms
+
+  //
+  // the compliment table keeps the first position of each term, holds the
+  //   extremes of T, and is emptied by generation (including when the
+  //   generation wraps); algorithm 2 reports the positions of the first
+  //   pair completed, and, reusing a table, allocates nothing once warm
+  //
+  static void test_complement()
+  {
+    demo::algo2::ComplementTable<element_t> table;
+    const element_t least    = std::numeric_limits<element_t>::min();
+    const element_t greatest = std::numeric_limits<element_t>::max();
+    for(int round=0; round<70000; ++round)
+    {
+      assert(table.size() == 0);
+      assert(table.find(least) == table.npos && table.find(0) == table.npos && table.find(greatest) == table.npos);
+      table.insert(least, 1);
+      table.insert(greatest, 2);
+      table.insert(least, 3);
+      // recorded (and the table grown) in the first generation only, and
+      //   so stale from then on, including once the generation wraps
+      if(0 == round) for(element_t x=0; x<100; ++x) table.insert(x, 10 + x);
+      assert(table.find(least) == 1 && table.find(greatest) == 2);
+      if(0 == round) for(element_t x=0; x<100; ++x) assert(table.find(x) == static_cast<std::size_t>(10 + x));
+      assert(0 == round || table.find(50) == table.npos);
+      table.clear();
+    }
+
+    // 7 + 5 completes at position 4, 7 first seen at 1
+    const std::vector<element_t> xs = { 3, 7, 7, 1, 5, 5 };
+    const auto pair = demo::algo2::find_two_sum_terms(xs, element_t(12), table);
+    assert(pair && pair->first == 1 && pair->second == 4);
+    assert(!demo::algo2::find_two_sum_terms(xs, element_t(13), table));
+    // unsigned terms larger than the sum have no compliment, and no pair
+    //   wraps around to the sum (2 + 2^64-1 is not 1)
+    const std::vector<std::uint64_t> us = { 9, 2, ~std::uint64_t(0), 3 };
+    assert(demo::algo2::has_two_sum_terms<std::uint64_t>(us, 5));
+    assert(!demo::algo2::has_two_sum_terms<std::uint64_t>(us, 4));
+    assert(!demo::algo2::has_two_sum_terms<std::uint64_t>(us, 1));
+
+    std::mt19937_64 gen(17);
+    std::vector<element_t> ys(1000000);
+    for(auto &y : ys) y = 2 * static_cast<element_t>(gen() >> 4);
+    demo::algo2::ComplementTable<element_t> reused;
+    assert(!demo::algo2::has_two_sum_terms(ys, element_t(1), reused));
+    const std::size_t warm = allocations;
+    for(element_t s : { 3, 5, 7 }) assert(!demo::algo2::has_two_sum_terms(ys, s, reused));
+    assert(demo::algo2::has_two_sum_terms(ys, ys[5] + ys[999999], reused));
+    assert(allocations == warm);
+    // likewise the table kept per thread
+    assert(!demo::algo2::has_two_sum_terms(ys, element_t(1)));
+    const std::size_t thread_warm = allocations;
+    assert(!demo::algo2::has_two_sum_terms(ys, element_t(9)));
+    assert(allocations == thread_warm);
+    // but released after a sequence of more distinct terms than it keeps,
+    //   and so grown afresh by the next
+    std::vector<element_t> zs(demo::algo2::ComplementTable<element_t>::thread_capacity + 1);
+    for(auto &z : zs) z = 2 * static_cast<element_t>(gen() >> 4);
+    assert(!demo::algo2::has_two_sum_terms(zs, element_t(1)));
+    const std::size_t released = allocations;
+    assert(!demo::algo2::has_two_sum_terms(zs, element_t(3)));
+    assert(allocations > released);
+    // as is a table passed in, on request
+    reused.release();
+    assert(reused.capacity() < 100 && reused.size() == 0);
+    assert(demo::algo2::has_two_sum_terms(ys, ys[5] + ys[999999], reused));
+    std::cout << "test complement passed" << std::endl;
+  } // test_complement
+
+  //
+  // the distinct estimate is within a few standard errors, algorithm 5
+  //   chooses by range and distinct terms, and its thresholds survive a
+  //   round trip through a file (and a missing file throws)
+  //
+  static void test_adaptive()
+  {
+    std::mt19937_64 gen(13);
+    for(std::size_t distinct : { 1, 10, 1000, 100000, 1000000 })
+    {
+      demo::algo5::DistinctEstimate estimate;
+      std::vector<std::uint64_t> values(distinct);
+      for(auto &v : values) v = gen();
+      // each value added several times, which must not count
+      for(int round=0; round<3; ++round) for(auto v : values) estimate.add(demo::algo2::mix(v));
+      assert(std::abs(estimate.estimate() - distinct) <= 0.12 * distinct + 1);
+    }
+
+    demo::algo5::Thresholds thresholds;
+    thresholds.bins_per_term = 16;
+    thresholds.hash_distinct = 2000;
+    demo::algo5::Dispatcher<element_t> adaptive(thresholds);
+    std::vector<element_t> xs(100000);
+    // a range of 4 bins per term
+    for(auto &x : xs) x = static_cast<element_t>(gen() % 400000);
+    assert(adaptive.choose(xs) == demo::algo5::Strategy::bitset);
+    // a wide range, of 1000 distinct terms
+    for(auto &x : xs) x = static_cast<element_t>(gen() % 1000) << 30;
+    assert(adaptive.choose(xs) == demo::algo5::Strategy::hash);
+    // a wide range, all distinct
+    for(auto &x : xs) x = static_cast<element_t>(gen() >> 8);
+    assert(adaptive.choose(xs) == demo::algo5::Strategy::sort);
+    assert(adaptive.has_two_sum_terms(xs, xs[3] + xs[77777]));
+
+    // a range past what the bitset accepts, though within bins per term
+    demo::algo5::Thresholds generous = thresholds;
+    generous.bins_per_term = 1e12;
+    demo::algo5::Dispatcher<element_t> wide(generous);
+    const element_t span = static_cast<element_t>(demo::algo1::SequenceCheck<element_t>::max_bins) * 4;
+    for(std::size_t k=0; k<xs.size(); ++k) xs[k] = static_cast<element_t>(k * (span / xs.size()));
+    assert(wide.choose(xs) != demo::algo5::Strategy::bitset);
+    assert(wide.has_two_sum_terms(xs, xs.back()));
+    assert(!wide.has_two_sum_terms(xs, xs.back() + 1));
+    // and a range within it, though past the memory cap
+    generous.bitset_bins = 1 << 20;
+    demo::algo5::Dispatcher<element_t> capped(generous);
+    for(std::size_t k=0; k<xs.size(); ++k) xs[k] = static_cast<element_t>(k * 100);
+    assert(capped.choose(xs) != demo::algo5::Strategy::bitset);
+    assert(capped.has_two_sum_terms(xs, xs.back()));
+
+    char path[] = "/tmp/sum-two-terms-test-XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    thresholds.save(path);
+    setenv("SUM_TWO_TERMS_THRESHOLDS", path, 1);
+    const auto loaded = demo::algo5::Thresholds::host();
+    assert(loaded.bins_per_term == thresholds.bins_per_term && loaded.hash_distinct == thresholds.hash_distinct);
+    assert(loaded.bitset_bins == thresholds.bitset_bins);
+    unsetenv("SUM_TWO_TERMS_THRESHOLDS");
+    unlink(path);
+    bool thrown = false;
+    try { demo::algo5::Thresholds::load(path); } catch(const std::system_error&) { thrown = true; }
+    assert(thrown);
+    std::cout << "test adaptive passed" << std::endl;
+  } // test_adaptive
+
+  //
+  // the bitset of algorithm 1 spans the pairing window alone, so that
+  //   outlying terms cost no space, and a window too wide is refused
+  //
+  static void test_outliers()
+  {
+    demo::algo1::SequenceCheck<element_t> check;
+    const element_t far = element_t(1) << 40;
+    const std::vector<element_t> xs = { 0, 1, far };
+    assert(check.has_two_sum_terms(xs, 1));
+    assert(!check.has_two_sum_terms(xs, 2));
+    bool thrown = false;
+    try { check.has_two_sum_terms(xs, far + 1); } catch(const std::length_error&) { thrown = true; }
+    assert(thrown);
+
+    // a dense cluster, and outliers above it
+    std::mt19937_64 gen(7);
+    std::vector<element_t> ys = { far, 3*far, 5*far };
+    for(int k=0; k<200; ++k) ys.push_back(static_cast<element_t>(gen() % 121) - 60);
+    for(element_t s=-130; s<=130; ++s) assert(check.has_two_sum_terms(ys, s) == brute_force(ys, s));
+    std::cout << "test outliers passed" << std::endl;
+  } // test_outliers
+
+  //
+  // each mirror kernel the processor supports agrees with a bit by bit
+  //   reflection, over sparse and dense bitsets, every in-word shift, and
+  //   word ranges of every length up to a few steps of the widest kernel
+  //
+  static void test_mirror()
+  {
+    std::vector<std::pair<const char*, demo::mirror::kernel_t>> kernels = { { "scalar", demo::mirror::scalar } };
+  #if defined(__x86_64__)
+    if(__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", demo::mirror::avx2 });
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) kernels.push_back({ "avx512", demo::mirror::avx512 });
+  #endif
+    std::mt19937_64 gen(1);
+    const std::size_t words = 64;
+    std::vector<std::uint64_t> bits(words + 1);
+    for(int trial=0; trial<4000; ++trial)
+    {
+      // one bit in 2^density set
+      const int density = trial % 12;
+      for(std::size_t w=0; w<words; ++w)
+      {
+        std::uint64_t x = gen();
+        for(int d=0; d<density; ++d) x &= gen();
+        bits[w] = x;
+      }
+      bits[words] = 0;
+      // a reflection point, and a range of the words w whose reflections,
+      //   bits p - 64w - 63 ... p - 64w, lie within the bitset
+      const std::size_t p = gen() % (2*64*words - 64);
+      const std::size_t lowest  = (p + 1 > 64*words) ? (p + 1 - 64*words + 63) / 64 : 0;
+      const std::size_t highest = (p + 1) / 64;
+      const std::size_t last    = std::min(highest, lowest + gen() % 40);
+      const std::size_t first   = std::min(last, lowest + gen() % 3);
+      bool expect = false;
+      for(std::size_t k=64*first; k<64*last; ++k)
+      {
+        if((bits[k/64] >> (k%64) & 1) && (bits[(p-k)/64] >> ((p-k)%64) & 1)) expect = true;
+      }
+      for(auto &kernel : kernels) assert(kernel.second(bits.data(), p, first, last) == expect);
+    }
+    for(auto &kernel : kernels) std::cout << "test mirror " << kernel.first << " passed" << std::endl;
+  } // test_mirror
+
+  //
+  // the streaming algorithm 2 finds the same pairs from an istream, and
+  //   fed in chunks of any size, and stops reading at the pair
+  //
+  static void test_stream()
+  {
+    std::mt19937_64 gen(7);
+    for(int trial=0; trial<200; ++trial)
+    {
+      std::vector<element_t> xs(gen() % 100);
+      for(auto &x : xs) x = static_cast<element_t>(gen() % 200) - 100;
+      const element_t sum = static_cast<element_t>(gen() % 300) - 150;
+      const bool expect = brute_force(xs, sum);
+
+      std::ostringstream os;
+      for(auto x : xs) os << x << " ";
+      std::istringstream is(os.str());
+      assert(demo::algo2::has_two_sum_terms(std::istream_iterator<element_t>(is), std::istream_iterator<element_t>(), sum) == expect);
+
+      demo::algo2::StreamCheck<element_t> check(sum);
+      for(std::size_t k=0; k<xs.size(); )
+      {
+        const std::size_t count = std::min<std::size_t>(xs.size() - k, 1 + gen() % 8);
+        const bool found = check.consume(xs.begin() + k, xs.begin() + k + count);
+        assert(found == brute_force(std::vector<element_t>(xs.begin(), xs.begin() + k + count), sum));
+        k += count;
+        if(found) break;
+      }
+      assert(check.found() == expect);
+    }
+    std::cout << "test stream passed" << std::endl;
+  } // test_stream
+
+  //
+  // the parallel algorithm 4 agrees with TwoSumIndex over sequences of
+  //   several chunks per worker, by worker count, including sequences
+  //   mapped from a file
+  //
+  static void test_parallel()
+  {
+    std::mt19937_64 gen(11);
+    const std::size_t n = 5 * demo::algo4::chunk + 123;
+    std::vector<element_t> xs(n);
+    // odd terms, so that even sums are found and odd ones are not
+    for(auto &x : xs) x = 2 * static_cast<element_t>(gen() % 100000000) + 1;
+    demo::algo3::TwoSumIndex<element_t> index(xs);
+    std::vector<element_t> sums = { 2, 3, xs[17] + xs[n - 5], xs[0] + xs[n - 1] + 1, 2 * xs[99] };
+    for(int k=0; k<4; ++k) sums.push_back(2 * static_cast<element_t>(gen() % 200000000) + 1);
+    for(auto s : sums)
+    {
+      for(unsigned threads : { 1, 2, 3, 4, 7 })
+      {
+        assert(demo::algo4::has_two_sum_terms(xs.begin(), xs.end(), s, threads) == index.has_two_sum_terms(s));
+      }
+    }
+
+    char path[] = "/tmp/sum-two-terms-test-XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    // written outside the assert, which NDEBUG would compile out
+    const ssize_t written = write(fd, xs.data(), n * sizeof(element_t));
+    assert(written == static_cast<ssize_t>(n * sizeof(element_t)));
+    (void)written;
+    close(fd);
+    {
+      demo::algo2::MappedSequence<element_t> mapped(path);
+      assert(mapped.size() == n);
+      for(auto s : sums)
+      {
+        assert(demo::algo4::has_two_sum_terms(mapped.begin(), mapped.end(), s, 3) == index.has_two_sum_terms(s));
+        assert(demo::algo2::has_two_sum_terms(mapped.begin(), mapped.end(), s) == index.has_two_sum_terms(s));
+      }
+    }
+    unlink(path);
+    bool thrown = false;
+    try { demo::algo2::MappedSequence<element_t> missing(path); } catch(const std::system_error&) { thrown = true; }
+    assert(thrown);
+
+    // threads waiting on a barrier for others that never start are
+    //   released when those are withdrawn
+    demo::algo4::Barrier barrier(4);
+    std::vector<std::thread> started;
+    for(int k=0; k<2; ++k) started.emplace_back([&] { barrier.wait(); });
+    barrier.leave(2);
+    for(auto &t : started) t.join();
+    std::cout << "test parallel passed" << std::endl;
+  } // test_parallel
+
+  //
+  // main test driver
+  //
+  int main(int argc, char *argv[])
+  {
+    for(std::uint64_t seed=1; seed<=4; ++seed)
+    {
+      differential<element_t>("dense", seed, -60, 60, 80, true);
+      differential<element_t>("sparse", seed, -1000000000, 1000000000, 200, false);
+      differential<element_t>("extreme", seed, std::numeric_limits<element_t>::min(), std::numeric_limits<element_t>::max(), 60, false);
+      differential<std::uint32_t>("unsigned", seed, 0, 4000, 120, true);
+      differential<std::int16_t>("int16_t", seed, -32768, 32767, 300, true);
+    }
+    test_sumset();
+    test_complement();
+    test_adaptive();
+    test_terms<element_t>("signed", -6, 6);
+    test_terms<std::uint32_t>("unsigned", 0, 9);
+    test_outliers();
+    test_mirror();
+    test_stream();
+    test_parallel();
+    return EXIT_SUCCESS;
+  } // main
+
+// *EOF*
@@ -0,0 +1,1061 @@
+// sum-two-terms.h
+// Mac Radigan
+
+  #pragma once
+
+  #include "mirror.h"
+  #include <algorithm>
+  #include <cmath>
+  #include <complex>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <numeric>
+  #include <optional>
+  #include <stdexcept>
+  #include <sys/types.h>
+  #include <type_traits>
+  #include <utility>
+  #include <vector>
+
+  // ==========================================================================
+  // has_two_sum_terms (Algorithm 1)
+  // ==========================================================================
+  //
+  //   returns true if there exists elements m and n in sequence xs such that 
+  //                sum = m + n, where xs and sum are given
+  //
+  //   inputs:
+  //
+  //     xs : vector<T>   - a sequence of terms to consider
+  //
+  //     sum : T          - the specified target sum for testing terms
+  //
+  //   template paramters:
+  //
+  //     T : class        - the (integral) data type of the terms and sum
+  //     
+  //   returns:
+  //
+  //     has_terms : bool - true  if the input sequence contains two elements
+  //                              equal to a given sum
+  //                        false otherwise
+  // 
+  // --------------------------------------------------------------------------
+  //
+  //
+  // Background:
+  //
+  //   Algorithm 1 makes use of the fact that: 
+  //     n = (n-k) + k 
+  //   holds true for any integers n and k.
+  //
+  //   Therefor, given knowledge of the elements present in the sequence xs 
+  //     between 0 and sum, we can apply the above formula as a test for 
+  //     existence.
+  //
+  //   Only terms x with both x and sum - x between the least and greatest 
+  //     terms of xs can take part:  the pairing window [max(min, sum - max), 
+  //     min(max, sum - min)], found at run time.  The histogram spans the 
+  //     window alone, with terms offset by its least (so negative terms 
+  //     need no special treatment), and so a few outlying terms cost no 
+  //     space.
+  //
+  //   Only whether a value occurs matters, except at the centre, sum/2, 
+  //     where it must occur twice, so the histogram is kept as a bitset 
+  //     of the values present, and the centre value counted alongside.
+  //
+  //
+  // Implementation:
+  //
+  //   Scan the input sequence once for its least and greatest terms, and 
+  //     from them the pairing window.
+  //
+  //   Build a histogram of unit bin size from the terms in the window, as 
+  //     a bitset over it, counting the terms equal to sum/2.
+  //
+  //   Scan the histogram up to half the number of bins, applying the formula:
+  //     n = (n-k) + k 
+  //
+  //   If the above equation holds for any element encountered, then two terms 
+  //     have been found that add to the given sum.
+  //
+  //   There is one additional case to consider, that is, when considering the 
+  //     center element of the histogram when the sum is even.  In this case, 
+  //     since is it required that the terms in the sum are at different 
+  //     positions, we must check that there are two terms in the sequence, 
+  //     in other words, that the centre count is greater than one.
+  //
+  //   The scan tests the lower half of the window a word at a time:  the 
+  //     bins k of a word, ANDed with the bins sum - k (an unaligned window 
+  //     of the histogram, bit-reversed), are zero unless a pair is found.  
+  //     The mirror kernels (see mirror.h) test 4 or 8 words an instruction 
+  //     with AVX2 or AVX-512 where the processor has them, returning on 
+  //     the first common bit.  The word at the end of the lower half, only 
+  //     partly within it, is probed a set bit at a time.  Terms outside the 
+  //     window set no bit in a padding word rather than being branched 
+  //     around, as a branch costs more when mispredicted than it saves.  
+  //     The bitset is kept between calls, and only the words in use 
+  //     cleared.  A window wider than max_bins throws std::length_error.  
+  //     Sums and differences of terms are formed in 128-bit arithmetic.
+  //
+  //
+  // Performance:
+  //
+  //   For a sequence xs, having N elements, with a pairing window of W 
+  //     values (at most the R values spanned by xs), we have:
+  //
+  //     average time complexity:       O(N)
+  //     worst case time complexity:    N + W/64 (over 4 or 8 for AVX2 or AVX-512)
+  //
+  //     space complexity:              W bits
+  //
+  //
+  //   Note that time complexity assumptions for the average case are not strictly 
+  //     valid without knowledge of the underlying statistical distribution of the 
+  //     input data.
+  //
+  //
+  //   Note that for a wide pairing window, the space complexity of this 
+  //     algorithm may be substantial (a window of 2^32 takes 512 MiB).  
+  //     Algorithm 2 provides better performance when the window is wide.
+  //
+  //
+  namespace demo::algo1 {
+    template<class T>
+    class SequenceCheck
+    {
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+
+      // wide enough for the sum (or difference) of any two terms
+      typedef __int128 wide_t;
+
+     public:
+
+      // largest pairing window histogrammed (2^34 bins, a 2 GiB bitset);
+      //   wider windows throw std::length_error
+      static constexpr std::size_t max_bins = std::size_t(1) << 34;
+
+      inline bool has_two_sum_terms(const std::vector<T> &xs, const T sum)
+      {
+        if(xs.size() < 2) return false;
+        // least and greatest terms, in a branch-free pass (which vectorizes
+        //   where minmax_element, comparing pairs of terms first, does not)
+        T least = xs[0], greatest = xs[0];
+        for(auto x : xs)
+        {
+          least    = std::min(least, x);
+          greatest = std::max(greatest, x);
+        }
+        // the pairing window [lo, hi]:  the terms x with both x and sum - x
+        //   within [least, greatest], symmetric about sum/2 (lo + hi = sum);
+        //   offsets from lo:  a term at offset k pairs with the term at
+        //   offset p - k, p = hi - lo, and both lie within [0, bins)
+        const wide_t s  = sum;
+        const wide_t lo = std::max<wide_t>(least, s - greatest);
+        const wide_t hi = std::min<wide_t>(greatest, s - least);
+        if(lo > hi) return false;
+        if(hi - lo >= static_cast<wide_t>(max_bins)) throw std::length_error("SequenceCheck: pairing window");
+        // build a histogram, as a bitset of the terms present in the window,
+        //   counting the centre term (which must be present twice)
+        //   alongside; a zero word pads the end, for the mirror kernels to
+        //   read past the last, and takes the (empty) bits of the terms
+        //   outside the window, so that the fill does not branch on them
+        const std::size_t p     = static_cast<std::size_t>(hi - lo);
+        const std::size_t bins  = p + 1;
+        const std::size_t words = (bins + 63) / 64;
+        if(once_.size() < words + 1) once_.resize(words + 1);
+        std::uint64_t *once = once_.data();
+        std::fill(once, once + words + 1, 0);
+        const std::uint64_t origin = static_cast<std::uint64_t>(static_cast<T>(lo));
+        const T centre = static_cast<T>(s/2);
+        std::size_t centres = 0;
+        for(auto x : xs)
+        {
+          const std::uint64_t k = static_cast<std::uint64_t>(x) - origin;
+          const bool inside = k < bins;
+          once[inside ? k/64 : words] |= std::uint64_t(inside) << (k%64);
+          centres += (x == centre);
+        }
+        // special case at the centre when the sum is even, must have at least two terms
+        if( !(p%2) && centres > 1 ) return true;
+        // each term in the lower half of the window, against its compliment:
+        //   offsets k < p - k
+        const std::size_t half = (p + 1) / 2;
+        if(0 == half) return false;
+        // the partial word at the end of the lower half is probed a set bit
+        //   at a time
+        auto probe = [&](std::size_t w) {
+          std::uint64_t bits = once[w];
+          if(half - w*64 < 64) bits &= (std::uint64_t(1) << (half - w*64)) - 1;
+          for(; bits; bits &= bits - 1)
+          {
+            // test if n = (n-k) + k
+            const std::size_t k = w*64 + __builtin_ctzll(bits);
+            if( once[(p-k)/64] >> ((p-k)%64) & 1 ) return true;
+          }
+          return false;
+        }; // probe
+        const std::size_t tail = (half - 1)/64;
+        // the whole words before it against their mirror image, many words
+        //   to an instruction
+        if(tail && mirror::any(once, p, 0, tail)) return true;
+        return probe(tail); // otherwise no such two terms
+      } // has_two_terms
+
+     private:
+      // histogram bitset:  the values present, offset by the window's least
+      std::vector<std::uint64_t> once_;
+    }; // SequenceCheck
+  } // demo::algo1
+
+
+  // ==========================================================================
+  // has_two_sum_terms (Algorithm 2)
+  // ==========================================================================
+  //
+  //   returns true if there exists elements m and n in sequence xs such that 
+  //                sum = m + n, where xs and sum are given
+  //
+  //   inputs:
+  //
+  //     xs : vector<T>   - a sequence of terms to consider
+  //
+  //     sum : T          - the specified target sum for testing terms
+  //
+  //     compliments : ComplementTable<T>
+  //                      - a table to reuse (optional, one per thread
+  //                        otherwise)
+  //
+  //   template paramters:
+  //
+  //     T : class        - the (integral) data type of the terms and sum
+  //
+  //   returns:
+  //
+  //     has_terms : bool - true  if the input sequence contains two elements
+  //                              equal to a given sum
+  //                        false otherwise
+  //
+  //     or, by find_two_sum_terms, the positions i < j of the first pair 
+  //       completed, if any
+  //
+  // --------------------------------------------------------------------------
+  //
+  //
+  // Background:
+  //
+  //   Algorithm 2 makes use of the algebraic group property that every number 
+  //     has an inverse, and thus we may rewrite:
+  //
+  //     s = m + n  as  n = s - m
+  //
+  //   Thus for each element m encountered in xs, we know uniquely of a 
+  //     corresponding n in xs that we seek.
+  //
+  //   Therefor, we may scan xs once to identify its compliment with respect 
+  //     to s.
+  //
+  //   Now, with a set of compliments, say xs', we may scan xs again to 
+  //     determine if any element exists in xs'.
+  //
+  //   If we find that an element in xs is found in the set of compliments, 
+  //     then we know the sum can be produced from two terms that exist in 
+  //     the sequence.
+  //
+  //   Since it is also required that the terms in the sum are at distictly 
+  //     different positions in the sequence, use a hash map for the set of 
+  //     compliments, and use the position to track the position of the 
+  //     original term.  When checking the compliment, verify that the 
+  //     position is also distinct from the original term.
+  //
+  // Implementation:
+  //
+  //   Initially an empty hash map, the ComplementTable below:  a flat, 
+  //     open-addressed table of compliments and the first positions they 
+  //     came from, which is emptied by advancing a generation rather than 
+  //     by freeing it.  Call this the compliment map cs.  A table may be 
+  //     passed in, so that once it has grown to the distinct terms of the 
+  //     sequences asked, further calls allocate nothing.  Otherwise a 
+  //     table kept per thread is used, alike for sequences of up to 2^20 
+  //     distinct terms, and released after larger ones so that an idle 
+  //     thread does not hold it.  Positions are limited to 2^48 terms.
+  //
+  //   Scan the input sequence, xs, for each x in xs.  For each x, first 
+  //     check the compliment map cs for x.  If x exists in cs, then it 
+  //     completes a term at an earlier (and so distinct) position, and we 
+  //     have found two terms that produce the sum.
+  //
+  //   Otherwise compute the compliment of the sum, s, and x, say:  
+  //     c = s - x, and insert the compliment c and the ordinal position of 
+  //     x (say k) into cs.  Checking before inserting is what keeps a term 
+  //     from pairing with itself, while still pairing equal terms at 
+  //     different positions (e.g. 2 = 1 + 1).  A compliment that is not 
+  //     representable in T (the subtraction overflows, as for unsigned 
+  //     terms greater than the sum) pairs with no term, and is skipped.
+  //
+  //   If the end of the sequence is reached without finding a matching x in 
+  //     the compliment map, cs, then there are no two terms in xs that will 
+  //     produce the sum.
+  //
+  //
+  // Performance:
+  //
+  //   For a sequence xs, having N elements, we have:
+  //
+  //     average time complexity:         O(N)
+  //     best case time complexity:       O(1)
+  //     worst case time complexity:      O(N)
+  //
+  //     average case space complexity:   O(N)
+  //     best  case space complexity:     O(1)
+  //     worst case space complexity:     O(N)
+  //
+  //
+  //   Note that the space complexity is dependent only on the number of 
+  //     unique elements in the input sequence (xs).
+  //
+  //
+  namespace demo::algo2 {
+
+    // SplitMix64 finalizer, spreading keys over the table
+    inline std::uint64_t mix(std::uint64_t z)
+    {
+      z ^= z >> 30;
+      z *= 0xbf58476d1ce4e5b9ULL;
+      z ^= z >> 27;
+      z *= 0x94d049bb133111ebULL;
+      z ^= z >> 31;
+      return z;
+    } // mix
+
+    // ==========================================================================
+    // ComplementTable
+    // ==========================================================================
+    //
+    //   a flat open-addressing map from terms to positions (linear probing,
+    //     at most half full), keeping the first position recorded for each
+    //     (positions up to max_position, 2^48 - 1, sharing a word with the
+    //     generation)
+    //
+    //   each slot is tagged with the generation it was filled in, and only
+    //     slots of the current generation are occupied, so clearing the
+    //     table advances the generation instead of touching the slots (they
+    //     are reset once in 2^16 clears, when the generation wraps).  The
+    //     slots are kept through clears, and only grown, so a table reused
+    //     for sequences of up to its capacity in distinct terms allocates
+    //     nothing after its first use, until release returns its slots
+    //
+    template<class T>
+    class ComplementTable
+    {
+      // the tag of a slot:  its generation above, the position below
+      static constexpr unsigned position_bits = 48;
+      static constexpr std::uint64_t position_mask = (std::uint64_t(1) << position_bits) - 1;
+
+      struct slot
+      {
+        T value;
+        std::uint64_t tag;
+      }; // slot
+
+     public:
+
+      // the position returned for a term not in the table
+      static constexpr std::size_t npos = ~std::size_t(0);
+
+      // the greatest position that can be recorded
+      static constexpr std::size_t max_position = position_mask;
+
+      explicit ComplementTable(std::size_t capacity = 0)
+      {
+        reserve(capacity);
+      };
+
+      // the number of terms the table kept per thread by has_two_sum_terms
+      //   holds between calls (2^20, 32 MiB of 64-bit terms); larger tables
+      //   are released after the call
+      static constexpr std::size_t thread_capacity = std::size_t(1) << 20;
+
+      // makes room for capacity terms, without growing while they are added
+      inline void reserve(std::size_t capacity)
+      {
+        std::size_t slots = 16;
+        while(slots < 2*capacity) slots <<= 1;
+        if(slots > slots_.size()) rehash(slots);
+      } // reserve
+
+      // the position recorded with x, or npos
+      inline std::size_t find(const T x) const
+      {
+        const std::size_t mask = slots_.size() - 1;
+        for(std::size_t i = mix(static_cast<std::uint64_t>(x)) & mask; ; i = (i + 1) & mask)
+        {
+          const slot &s = slots_[i];
+          if((s.tag >> position_bits) != generation_) return npos;
+          if(s.value == x) return s.tag & position_mask;
+        }
+      } // find
+
+      // records x at position k (at most max_position), unless x is
+      //   already recorded
+      inline void insert(const T x, const std::size_t k)
+      {
+        if(2*(size_ + 1) > slots_.size()) rehash(2*slots_.size());
+        const std::size_t mask = slots_.size() - 1;
+        for(std::size_t i = mix(static_cast<std::uint64_t>(x)) & mask; ; i = (i + 1) & mask)
+        {
+          slot &s = slots_[i];
+          if((s.tag >> position_bits) != generation_)
+          {
+            s.value = x;
+            s.tag   = (generation_ << position_bits) | k;
+            ++size_;
+            return;
+          }
+          if(s.value == x) return;
+        }
+      } // insert
+
+      // empties the table, keeping its slots
+      inline void clear()
+      {
+        size_ = 0;
+        if(++generation_ < (std::uint64_t(1) << (64 - position_bits))) return;
+        for(auto &s : slots_) s.tag = 0;
+        generation_ = 1;
+      } // clear
+
+      // empties the table, and frees its slots down to the least table
+      inline void release()
+      {
+        std::vector<slot>(16, slot{ T(), 0 }).swap(slots_);
+        size_ = 0;
+        generation_ = 1;
+      } // release
+
+      // the number of terms recorded
+      inline std::size_t size() const
+      {
+        return size_;
+      } // size
+
+      // the number of terms the table holds without growing
+      inline std::size_t capacity() const
+      {
+        return slots_.size() / 2;
+      } // capacity
+
+     private:
+
+      inline void rehash(std::size_t slots)
+      {
+        std::vector<slot> old(slots, slot{ T(), 0 });
+        old.swap(slots_);
+        const std::uint64_t generation = generation_;
+        size_ = 0;
+        generation_ = 1;
+        for(const auto &s : old)
+        {
+          if((s.tag >> position_bits) == generation) insert(s.value, s.tag & position_mask);
+        }
+      } // rehash
+
+      std::vector<slot> slots_;
+      std::size_t size_ = 0;
+      // generation 0 marks the slots never filled
+      std::uint64_t generation_ = 1;
+
+    }; // ComplementTable
+
+    // positions i < j of two terms of xs summing to sum, if any, by way of
+    //   the given table (which is cleared first)
+    template<class T>
+    std::optional<std::pair<std::size_t, std::size_t>> find_two_sum_terms(const std::vector<T> &xs, const T sum, ComplementTable<T> &compliments)
+    {
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+      // positions share a word with the generation of the table
+      if(xs.size() > compliments.max_position) throw std::length_error("find_two_sum_terms: positions beyond 2^48");
+      // hash map of compliments: CS := { c : sum-x=c forall x in xs }
+      compliments.clear();
+      for(std::size_t k=0; k<xs.size(); ++k)
+      {
+        const T x = xs[k];
+        // check whether x completes an earlier term; the compliment found is
+        //   necessarily at a distinct (earlier) position, since the
+        //   compliment of x itself is only recorded after the check
+        const std::size_t x_bar = compliments.find(x);
+        if( x_bar != compliments.npos ) return std::make_pair(x_bar, k);
+        // a compliment out of the range of T pairs with no term
+        T diff;
+        if( !__builtin_sub_overflow(sum, x, &diff) ) compliments.insert(diff, k);
+      } // foreach index k of x in xs
+      return std::nullopt; // otherwise no such two terms
+    } // find_two_sum_terms
+
+    template<class T>
+    bool has_two_sum_terms(const std::vector<T> &xs, const T sum, ComplementTable<T> &compliments)
+    {
+      return find_two_sum_terms(xs, sum, compliments).has_value();
+    } // has_two_sum_terms
+
+    // by a table kept per thread, of up to thread_capacity terms between
+    //   calls (callers reusing a larger table pass their own)
+    template<class T>
+    bool has_two_sum_terms(const std::vector<T> &xs, const T sum)
+    {
+      thread_local ComplementTable<T> compliments;
+      const bool found = has_two_sum_terms(xs, sum, compliments);
+      if(compliments.capacity() > compliments.thread_capacity) compliments.release();
+      return found;
+    } // has_two_sum_terms
+  } // demo::algo2
+
+
+  // ==========================================================================
+  // has_two_sum_terms (Algorithm 3)
+  // ==========================================================================
+  //
+  //   an index over a sequence xs, built once, answering whether there 
+  //     exists elements m and n in xs such that sum = m + n for many sums
+  //
+  //   inputs:
+  //
+  //     xs : vector<T>      - a sequence of terms to consider
+  //
+  //     sums : vector<T>    - the target sums for testing terms (query)
+  //
+  //     k : size_t          - the number of terms to sum (find_terms)
+  //
+  //   template paramters:
+  //
+  //     T : class           - the (integral) data type of the terms and sums
+  //
+  //   returns:
+  //
+  //     has_terms : bool    - per sum, true  if the input sequence contains 
+  //                                          two elements equal to the sum
+  //                                    false otherwise
+  //
+  //   and, from the same index, the positions of the terms:
+  //
+  //     find_pair           - positions i < j of two terms summing to sum
+  //     for_each_pair       - every such pair of positions, to a callback
+  //     count_pairs         - the number of such pairs of positions
+  //     find_terms          - positions of k terms summing to sum
+  // 
+  // --------------------------------------------------------------------------
+  //
+  //
+  // Background:
+  //
+  //   Algorithms 1 and 2 rebuild their histogram or compliment map from xs 
+  //     for every sum asked.  When many sums are asked of one sequence, the 
+  //     work that depends on xs alone can be done once.
+  //
+  //   Only the distinct values of xs matter, together with whether a value 
+  //     occurs more than once (so that s = m + m may use two positions).
+  //     Sorted, the distinct values admit the two-pointer sweep:  for 
+  //     a < b, if a + b < s then a pairs with nothing up to b, and if 
+  //     a + b > s then b pairs with nothing down to a.
+  //
+  //   When the values span a small range R, every sum can be decided at 
+  //     once:  the square of the polynomial P(z) = sum of z^x over the 
+  //     distinct values x has a nonzero coefficient at z^s exactly when s 
+  //     is the sum of two values (the sumset of xs).  The square costs 
+  //     O(R log R) with the fast Fourier transform, after which each sum 
+  //     is a table lookup.
+  //
+  //
+  // Implementation:
+  //
+  //   On construction, sort a copy of xs and collapse it to its distinct 
+  //     values and their multiplicities.
+  //
+  //   For a single sum, return false outright if the sum lies outside 
+  //     [2 min, 2 max].  Otherwise, when s is even, test the centre value 
+  //     s/2 by binary search (it must occur twice), then sweep the two 
+  //     pointers over the values that can take part, between s - max and 
+  //     s - min, found by binary search.
+  //
+  //   For a batch of sums, answer each distinct sum as above, in ascending 
+  //     order, while counting the steps taken.  When the range of values 
+  //     is within the dense limit and the steps have come to the cost of 
+  //     the transform, form the sumset table by FFT (after which all sums, 
+  //     batched or not, are lookups).  Whether sweeps end early depends on 
+  //     the structure of xs and the sums, so rather than predict it, a 
+  //     batch pays at most about twice the cheaper of the two.  The 
+  //     coefficient at 2x counts the pair (x, x) once; it is discounted, 
+  //     and the multiplicity of x decides that pair instead.
+  //
+  //   The sort carries each term's position along, so that the positions 
+  //     of each distinct value are kept in ascending order.  The sweep 
+  //     stops at the first pair of values for an existence check, and 
+  //     otherwise continues past it:  each pair of values found yields the 
+  //     products of their positions, and the centre value the pairs among 
+  //     its own, so enumeration and counting reuse the index as built (and 
+  //     a sum absent from the sumset table costs a lookup).
+  //
+  //   For k terms, choose values ascending from the distinct values, each 
+  //     no more often than it occurs, down to the last two, which are the 
+  //     two-pointer sweep (duplicates never arise, as each distinct value 
+  //     is tried once per place).  A choice is abandoned once k times it 
+  //     exceeds the sum, or once the greatest values cannot reach it.  For 
+  //     four terms, when the pairs of values are within the dense limit, 
+  //     the sums of all pairs are sorted once (meet in the middle):  the 
+  //     four are then a pair u <= v and a pair u' <= v' with v <= u', the 
+  //     second found among the pairs summing to the rest by a pointer 
+  //     falling as the first rises.
+  //
+  //   Sums are formed in 128-bit arithmetic, so terms of any width (and 
+  //     unsigned terms) neither overflow nor wrap.
+  //
+  //
+  // Performance:
+  //
+  //   For a sequence xs, having N elements, U of them distinct, spanning 
+  //     a range R, and Q sums, we have:
+  //
+  //     construction time complexity:     O(N log N)
+  //     per sum time complexity:          O(U)       (the sweep)
+  //                                       O(1)       (out of range, or with
+  //                                                   the sumset table)
+  //     sumset time complexity:           O(R log R) (once)
+  //     per sum enumeration complexity:   O(U + P)   (for P pairs)
+  //     per sum k terms complexity:       O(U^(k-1)) (k > 1)
+  //                                       O(U^2)     (k = 4, with the
+  //                                                   pair sums)
+  //
+  //     space complexity:                 O(N), O(R) with the sumset,
+  //                                       and O(U^2) with the pair sums
+  //
+  //
+  //   Note that over a batch, the cost per sum is O(U) at worst with the 
+  //     sweep and falls to O(R log R / Q + 1) once the table is formed.  A 
+  //     batch over a range beyond the dense limit never forms the table, 
+  //     and each of its distinct sums stays an O(U) sweep; sorting the 
+  //     sums (O(Q log Q)) shares only repeated sums and cache locality.
+  //
+  //
+  namespace demo::algo3 {
+    template<class T>
+    class TwoSumIndex
+    {
+      static_assert(std::is_integral_v<T>, "terms must be integral");
+
+      // wide enough for the sum (or difference) of any two terms
+      typedef __int128 wide_t;
+
+     public:
+
+      // largest range of values for which a sumset table is formed
+      static constexpr std::size_t default_dense_limit = std::size_t(1) << 20;
+
+      explicit TwoSumIndex(const std::vector<T> &xs, std::size_t dense_limit = default_dense_limit)
+       : dense_limit_(dense_limit)
+      {
+        // terms with their positions, by value and then by position
+        std::vector<std::pair<T, std::size_t>> sorted(xs.size());
+        for(std::size_t k=0; k<xs.size(); ++k) sorted[k] = { xs[k], k };
+        std::sort(sorted.begin(), sorted.end());
+        order_.resize(sorted.size());
+        for(std::size_t k=0; k<sorted.size(); ++k)
+        {
+          order_[k] = sorted[k].second;
+          if(k && sorted[k].first == sorted[k-1].first) continue;
+          values_.push_back(sorted[k].first);
+          starts_.push_back(k);
+        }
+        starts_.push_back(sorted.size());
+      };
+
+      inline bool has_two_sum_terms(const T sum) const
+      {
+        std::size_t steps = 0;
+        return lookup(sum, steps);
+      } // has_two_sum_terms
+
+      // answers has_two_sum_terms for each of sums, in order
+      inline std::vector<bool> query(const std::vector<T> &sums)
+      {
+        std::vector<bool> found(sums.size());
+        if(!sumset_.empty())
+        {
+          std::size_t steps = 0;
+          for(std::size_t k=0; k<sums.size(); ++k) found[k] = lookup(sums[k], steps);
+          return found;
+        }
+        // the sums are answered in ascending order, so that a repeated sum
+        //   is swept once, and neighbouring sums sweep overlapping windows
+        //   of the values while they are still in cache
+        std::vector<std::size_t> order(sums.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sums[a] < sums[b]; });
+        // sweep until the steps taken would have paid for the sumset table,
+        //   then form it, so a batch costs at most about twice the cheaper
+        //   of the two without predicting which that is
+        const double budget = sumset_cost();
+        std::size_t steps = 0;
+        for(std::size_t k=0; k<order.size(); ++k)
+        {
+          const std::size_t q = order[k];
+          if(k && sums[q] == sums[order[k-1]])
+          {
+            found[q] = found[order[k-1]];
+            continue;
+          }
+          if(sumset_.empty() && budget > 0 && steps > budget) build_sumset();
+          found[q] = lookup(sums[q], steps);
+        }
+        return found;
+      } // query
+
+      // positions i < j of two terms summing to sum, if any
+      inline std::optional<std::pair<std::size_t, std::size_t>> find_pair(const T sum) const
+      {
+        std::optional<std::pair<std::size_t, std::size_t>> found;
+        for_each_pair(sum, [&](std::size_t i, std::size_t j) { found.emplace(i, j); return false; });
+        return found;
+      } // find_pair
+
+      // calls f(i, j) for each pair of positions i < j of terms summing to
+      //   sum, pair by pair without collecting them; a callback returning
+      //   bool stops the enumeration by returning false
+      template<class F>
+      inline void for_each_pair(const T sum, F f) const
+      {
+        // true to go on
+        const auto call = [&f](std::size_t i, std::size_t j) -> bool
+        {
+          if constexpr (std::is_same_v<std::invoke_result_t<F&, std::size_t, std::size_t>, bool>) return f(i, j);
+          else { f(i, j); return true; }
+        };
+        std::size_t steps = 0;
+        pairs(sum, steps, [&](std::size_t u, std::size_t v)
+        {
+          for(std::size_t a=starts_[u]; a<starts_[u+1]; ++a)
+          {
+            for(std::size_t b=(u == v ? a+1 : starts_[v]); b<starts_[v+1]; ++b)
+            {
+              if(!call(std::min(order_[a], order_[b]), std::max(order_[a], order_[b]))) return true;
+            }
+          }
+          return false;
+        });
+      } // for_each_pair
+
+      // the number of pairs of positions i < j of terms summing to sum
+      inline std::uint64_t count_pairs(const T sum) const
+      {
+        std::uint64_t pairs_found = 0;
+        std::size_t steps = 0;
+        pairs(sum, steps, [&](std::size_t u, std::size_t v)
+        {
+          const std::uint64_t m = count(u);
+          pairs_found += (u == v) ? m * (m - 1) / 2 : m * count(v);
+          return false;
+        });
+        return pairs_found;
+      } // count_pairs
+
+      // ascending positions of k terms summing to sum, if any; for four
+      //   terms this forms the table of pair sums, if within the dense limit
+      inline std::optional<std::vector<std::size_t>> find_terms(const T sum, const std::size_t k)
+      {
+        std::vector<std::size_t> chosen;
+        if(2 == k)
+        {
+          const auto pair = find_pair(sum);
+          if(!pair) return std::nullopt;
+          return std::vector<std::size_t>{ pair->first, pair->second };
+        }
+        if(k > order_.size()) return std::nullopt;
+        if(4 == k && duos_.empty())
+        {
+          const std::size_t u = values_.size();
+          if(u * (u + 1) / 2 <= dense_limit_) build_duos();
+        }
+        const bool found = (4 == k && !duos_.empty()) ? quartet(sum, chosen) : choose(k, 0, sum, chosen);
+        if(!found) return std::nullopt;
+        // the first positions of each value chosen, as often as it was
+        std::vector<std::size_t> positions;
+        for(std::size_t n=0; n<chosen.size(); ++n)
+        {
+          const std::size_t again = std::count(chosen.begin(), chosen.begin() + n, chosen[n]);
+          positions.push_back(order_[starts_[chosen[n]] + again]);
+        }
+        std::sort(positions.begin(), positions.end());
+        return positions;
+      } // find_terms
+
+      // the number of distinct terms
+      inline std::size_t size() const
+      {
+        return values_.size();
+      } // size
+
+     private:
+
+      // the number of positions of distinct term u
+      inline std::size_t count(std::size_t u) const
+      {
+        return starts_[u+1] - starts_[u];
+      } // count
+
+      // decides one sum, adding the sweep steps taken to steps
+      inline bool lookup(const T sum, std::size_t &steps) const
+      {
+        if(!sumset_.empty())
+        {
+          const wide_t s = static_cast<wide_t>(sum) - 2 * static_cast<wide_t>(values_.front());
+          return s >= 0 && s < static_cast<wide_t>(sumset_.size()) && sumset_[static_cast<std::size_t>(s)];
+        }
+        return pairs(sum, steps, [](std::size_t, std::size_t) { return true; });
+      } // lookup
+
+      // calls visit(u, v) for each pair of distinct terms u <= v summing to
+      //   sum (u = v for a term at two positions or more), until visit
+      //   returns true, and returns whether it did; adds the sweep steps
+      //   taken to steps
+      template<class Visit>
+      inline bool pairs(const T sum, std::size_t &steps, Visit visit) const
+      {
+        if(values_.empty()) return false;
+        const wide_t s = sum;
+        const wide_t lo = values_.front();
+        const wide_t hi = values_.back();
+        // no two terms reach a sum outside [2 min, 2 max]
+        if( s < 2*lo || s > 2*hi ) return false;
+        if(!sumset_.empty() && !sumset_[static_cast<std::size_t>(s - 2*lo)]) return false;
+        // each binary search below counts as a step per halving
+        steps += 3 * (64 - __builtin_clzll(values_.size()));
+        // centre value, which must be present at two positions
+        if( !(s%2) )
+        {
+          const T centre = static_cast<T>(s/2);
+          const std::size_t c = std::lower_bound(values_.begin(), values_.end(), centre) - values_.begin();
+          if( c != values_.size() && values_[c] == centre && count(c) > 1 && visit(c, c) ) return true;
+        }
+        // sweep over the values that can pair:  s - max <= x <= s - min
+        std::size_t i = std::lower_bound(values_.begin(), values_.end(), static_cast<T>(std::max(lo, s - hi))) - values_.begin();
+        std::size_t j = std::upper_bound(values_.begin(), values_.end(), static_cast<T>(std::min(hi, s - lo))) - values_.begin();
+        if(0 == j) return false;
+        for(--j; i < j; ++steps)
+        {
+          const wide_t t = static_cast<wide_t>(values_[i]) + values_[j];
+          if(t == s)
+          {
+            if(visit(i, j)) return true;
+            ++i; --j;
+          }
+          else if(t < s) ++i; else --j;
+        } // two-pointer sweep i < j
+        return false; // otherwise no such two terms
+      } // pairs
+
+      // chooses k more distinct terms onto chosen, ascending from term
+      //   first, summing to s, each no more often than it occurs; true if
+      //   it could, leaving chosen as it was otherwise
+      inline bool choose(std::size_t k, std::size_t first, const wide_t s, std::vector<std::size_t> &chosen) const
+      {
+        const std::size_t n = values_.size();
+        if(0 == k) return 0 == s;
+        if(first >= n) return false;
+        // positions of term u not yet chosen (only first can have been)
+        const std::size_t taken = std::count(chosen.begin(), chosen.end(), first);
+        const auto spare = [&](std::size_t u) { return count(u) - (u == first ? taken : 0); };
+        if(1 == k)
+        {
+          if(s < values_[first] || s > values_.back()) return false;
+          const std::size_t u = std::lower_bound(values_.begin() + first, values_.end(), static_cast<T>(s)) - values_.begin();
+          if(u == n || values_[u] != s || 0 == spare(u)) return false;
+          chosen.push_back(u);
+          return true;
+        }
+        if(2 == k)
+        {
+          // the two-pointer sweep over terms first ... n-1, with i = j
+          //   allowed for a term with two spare positions
+          for(std::size_t i=first, j=n-1; i <= j; )
+          {
+            const wide_t t = static_cast<wide_t>(values_[i]) + values_[j];
+            if(t == s && (i < j ? spare(i) > 0 : spare(i) > 1))
+            {
+              chosen.push_back(i);
+              chosen.push_back(j);
+              return true;
+            }
+            if(t < s || (t == s && i < j)) ++i;
+            else if(0 == j--) break;
+          } // two-pointer sweep i <= j
+          return false;
+        }
+        for(std::size_t u=first; u<n; ++u)
+        {
+          if(0 == spare(u)) continue;
+          const wide_t x = values_[u];
+          // the k terms are at least k x, and at most x plus k-1 times max
+          if(x * static_cast<wide_t>(k) > s) break;
+          if(x + static_cast<wide_t>(k - 1) * values_.back() < s) continue;
+          chosen.push_back(u);
+          if(choose(k - 1, u, s - x, chosen)) return true;
+          chosen.pop_back();
+        } // foreach term u taking the next place
+        return false;
+      } // choose
+
+      // four terms by the table of pair sums:  pairs u <= v and u' <= v'
+      //   with v <= u', so that each set of four is seen once.  As the
+      //   pairs below ascend, the rest they need descends, and is tracked
+      //   by a second pointer falling from the top of the table
+      inline bool quartet(const T sum, std::vector<std::size_t> &chosen) const
+      {
+        const wide_t s = sum;
+        std::size_t high = duos_.size();
+        for(const auto &low : duos_)
+        {
+          // the pair above sums to at least as much as the pair below
+          if(2 * low.sum > s) break;
+          const wide_t rest = s - low.sum;
+          // the first pair summing to the rest or more, by u descending
+          while(high > 0 && duos_[high-1].sum >= rest) --high;
+          for(std::size_t h=high; h<duos_.size() && duos_[h].sum == rest && duos_[h].u >= low.v; ++h)
+          {
+            chosen = { low.u, low.v, duos_[h].u, duos_[h].v };
+            // u' > v shares no term with the pair below; u' = v must have
+            //   a position for each time v is chosen
+            if(duos_[h].u > low.v || static_cast<std::size_t>(std::count(chosen.begin(), chosen.end(), low.v)) <= count(low.v)) return true;
+          }
+        }
+        chosen.clear();
+        return false;
+      } // quartet
+
+      // the sums of all pairs of distinct terms u <= v (u = v for a term at
+      //   two positions or more), by sum and then by u descending
+      inline void build_duos()
+      {
+        for(std::size_t u=0; u<values_.size(); ++u)
+        {
+          for(std::size_t v=(count(u) > 1 ? u : u+1); v<values_.size(); ++v)
+          {
+            duos_.push_back({ static_cast<wide_t>(values_[u]) + values_[v], u, v });
+          }
+        }
+        std::sort(duos_.begin(), duos_.end(), [](const duo &a, const duo &b) { return a.sum < b.sum || (a.sum == b.sum && a.u > b.u); });
+      } // build_duos
+
+      // span of the values, max - min + 1, if within the dense limit
+      inline std::size_t span() const
+      {
+        if(values_.empty()) return 0;
+        const wide_t r = static_cast<wide_t>(values_.back()) - values_.front() + 1;
+        return (r <= static_cast<wide_t>(dense_limit_)) ? static_cast<std::size_t>(r) : 0;
+      } // span
+
+      // the cost of forming the sumset table, in sweep steps (two
+      //   transforms of length L, of log L passes each), or zero if the
+      //   range of values is beyond the dense limit
+      inline double sumset_cost() const
+      {
+        const std::size_t r = span();
+        if(0 == r) return 0;
+        std::size_t length = 1, stages = 0;
+        while(length < 2*r) { length <<= 1; ++stages; }
+        return 2.0 * length * stages;
+      } // sumset_cost
+
+      inline void build_sumset()
+      {
+        const std::size_t r = span();
+        std::size_t length = 1;
+        while(length < 2*r) length <<= 1;
+        // term[x - min]:  0 absent, 1 once, 2 more than once
+        std::vector<std::uint8_t> term(r, 0);
+        std::vector<std::complex<double>> p(length);
+        for(std::size_t k=0; k<values_.size(); ++k)
+        {
+          const std::size_t x = static_cast<std::size_t>(static_cast<wide_t>(values_[k]) - values_.front());
+          term[x] = (count(k) > 1) ? 2 : 1;
+          p[x] = 1;
+        }
+        // P(z)^2 by transform, pointwise square, and inverse transform
+        fft(p, false);
+        for(auto &z : p) z = product(z, z);
+        fft(p, true);
+        sumset_.assign(2*r - 1, false);
+        for(std::size_t s=0; s<2*r-1; ++s)
+        {
+          const long pairs = std::lround(p[s].real() / length);
+          const bool self  = !(s%2) && term[s/2];
+          sumset_[s] = (pairs - self > 0) || (self && term[s/2] > 1);
+        }
+      } // build_sumset
+
+      // the complex product, written out:  operator* is required to recover
+      //   infinities from NaN results (Annex G), which costs a library call
+      //   per product unless compiled with -ffast-math
+      static inline std::complex<double> product(const std::complex<double> &x, const std::complex<double> &y)
+      {
+        return { x.real()*y.real() - x.imag()*y.imag(), x.real()*y.imag() + x.imag()*y.real() };
+      } // product
+
+      // in-place iterative radix-2 transforms:  the forward transform by
+      //   decimation in frequency leaves its output in bit-reversed order,
+      //   and the inverse by decimation in time takes its input in that
+      //   order, so a pointwise product between them needs no reordering
+      //   pass (the inverse is unnormalized)
+      static inline void fft(std::vector<std::complex<double>> &p, bool inverse)
+      {
+        const std::size_t n = p.size();
+        // twiddles computed directly, rather than by repeated products, to
+        //   keep the rounding error from compounding
+        std::vector<std::complex<double>> roots(n/2);
+        const double theta = (inverse ? 2 : -2) * M_PI / n;
+        for(std::size_t k=0; k<n/2; ++k) roots[k] = std::polar(1.0, theta * k);
+        // through plain pointers, as stores through the vector could alias
+        //   its own storage pointer, reloaded on every iteration otherwise
+        std::complex<double> *a = p.data();
+        const std::complex<double> *w = roots.data();
+        for(std::size_t len = inverse ? 2 : n; len >= 2 && len <= n; len = inverse ? len << 1 : len >> 1)
+        {
+          const std::size_t half   = len / 2;
+          const std::size_t stride = n / len;
+          for(std::size_t i=0; i<n; i+=len)
+          {
+            for(std::size_t j=0; j<half; ++j)
+            {
+              const std::complex<double> u = a[i+j];
+              if(inverse)
+              {
+                const std::complex<double> v = product(a[i+j+half], w[j*stride]);
+                a[i+j]      = u + v;
+                a[i+j+half] = u - v;
+              }
+              else
+              {
+                const std::complex<double> v = a[i+j+half];
+                a[i+j]      = u + v;
+                a[i+j+half] = product(u - v, w[j*stride]);
+              }
+            }
+          }
+        } // butterfly stages
+      } // fft
+
+      // distinct terms, ascending
+      std::vector<T> values_;
+      // positions of the terms, by value and then by position
+      std::vector<std::size_t> order_;
+      // where each distinct term begins in order_, and the end of order_
+      std::vector<std::size_t> starts_;
+      // a sum of two distinct terms u <= v
+      struct duo { wide_t sum; std::size_t u, v; };
+      // sums of all pairs of distinct terms, once formed
+      std::vector<duo> duos_;
+      // sums reachable by two terms, offset by 2 min, once formed
+      std::vector<bool> sumset_;
+      std::size_t dense_limit_;
+    }; // TwoSumIndex
+  } // demo::algo3
+
+// *EOF*